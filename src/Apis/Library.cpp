@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstdlib>
 
 #include "../Interfaces/Books.hpp"
 #include "../Interfaces/Categories.hpp"
@@ -9,12 +10,32 @@
 #include "../Tests/UnitTests/CategoryTests.hpp"
 #include "../Tests/UnitTests/UserTests.hpp"
 #include "../Tests/UnitTests/TransactionTests.hpp"
+#include "../Tests/UnitTests/AuditTests.hpp"
+#include "../Tests/UnitTests/SessionStoreTests.hpp"
+#include "../Tests/UnitTests/FramingTests.hpp"
+#include "../Tests/UnitTests/JsonRecordReaderTests.hpp"
+#include "../Tests/UnitTests/JournalTests.hpp"
+#include "../Tests/UnitTests/StoreFileTests.hpp"
+#include "../Tests/UnitTests/PageCursorTests.hpp"
+#include "../Tests/UnitTests/ResponseBufferTests.hpp"
+#include "../Tests/UnitTests/AuthPoolTests.hpp"
+#include "../Tests/Benchmarks/NGramBenchmark.hpp"
+#include "../Tests/Benchmarks/TransactionStorageBenchmark.hpp"
 
 void RunUnitTests() {
     BookTests bookTests;
     CategoryTests categoryTests;
     UserTests userTests;
     TransactionTests transactionTests;
+    AuditTests auditTests;
+    SessionStoreTests sessionStoreTests;
+    FramingTests framingTests;
+    JsonRecordReaderTests jsonRecordReaderTests;
+    JournalTests journalTests;
+    StoreFileTests storeFileTests;
+    PageCursorTests pageCursorTests;
+    ResponseBufferTests responseBufferTests;
+    AuthPoolTests authPoolTests;
     
     std::cout << "Running Unit Tests...\n\n";
 
@@ -29,6 +50,63 @@ void RunUnitTests() {
 
     std::cout << "\nTransaction Tests:\n";
     transactionTests.RunAllTests();
+
+    std::cout << "\nAudit Tests:\n";
+    auditTests.RunAllTests();
+
+    std::cout << "\nSession Store Tests:\n";
+    sessionStoreTests.RunAllTests();
+
+    std::cout << "\nFraming Tests:\n";
+    framingTests.RunAllTests();
+
+    std::cout << "\nJSON Record Reader Tests:\n";
+    jsonRecordReaderTests.RunAllTests();
+
+    std::cout << "\nJournal Tests:\n";
+    journalTests.RunAllTests();
+
+    std::cout << "\nStore File Tests:\n";
+    storeFileTests.RunAllTests();
+
+    std::cout << "\nPage Cursor Tests:\n";
+    pageCursorTests.RunAllTests();
+
+    std::cout << "\nResponse Buffer Tests:\n";
+    responseBufferTests.RunAllTests();
+
+    std::cout << "\nAuth Pool Tests:\n";
+    authPoolTests.RunAllTests();
+}
+
+// False when a benchmark's own correctness check fails.
+bool RunBenchmarks() {
+    NGramBenchmark ngramBenchmark;
+    TransactionStorageBenchmark transactionStorageBenchmark;
+
+    std::cout << "Running Benchmarks...\n\n";
+
+    std::cout << "\nN-gram Similarity Benchmark:\n";
+    if (!ngramBenchmark.RunAll()) return false;
+
+    std::cout << "\nTransaction Storage Benchmark:\n";
+    return transactionStorageBenchmark.RunAll();
+}
+
+// Reads "--backlog=N", "--io-threads=N" and "--workers=N" after "server".
+ServerConfig ParseServerConfig(int argc, char* argv[]) {
+    ServerConfig config;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) continue;
+        std::string name = arg.substr(0, eq);
+        int value = std::atoi(arg.c_str() + eq + 1);
+        if (name == "--backlog") config.backlog = value;
+        else if (name == "--io-threads") config.ioThreads = value;
+        else if (name == "--workers") config.workerThreads = value;
+    }
+    return config;
 }
 
 int main(int argc, char* argv[])
@@ -38,11 +116,25 @@ int main(int argc, char* argv[])
         return 0;
     }
 
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        return RunBenchmarks() ? 0 : 1;
+    }
+
+    // convert <source> <target>: .json <-> .bin transaction files, direction by source extension.
+    if (argc > 3 && std::string(argv[1]) == "convert") {
+        std::string source = argv[2], target = argv[3];
+        bool fromJson = source.size() >= 5 && source.compare(source.size() - 5, 5, ".json") == 0;
+        bool converted = fromJson ? Transactions::ConvertJsonToBinary(source, target)
+                                  : Transactions::ConvertBinaryToJson(source, target);
+        std::cout << (converted ? "Converted " : "Failed to convert ") << source << " -> " << target << std::endl;
+        return converted ? 0 : 1;
+    }
+
     std::cout << "Library Management System\n";
 
     if (argc > 1 && std::string(argv[1]) == "server") {
         try {
-            LibraryServer server(8080);
+            LibraryServer server(8080, ParseServerConfig(argc, argv));
             server.Start();
         } catch (const std::exception& e) {
             std::cerr << "Server error: " << e.what() << std::endl;
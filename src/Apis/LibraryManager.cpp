@@ -1,281 +1,394 @@
 #include <iostream>
 #include <string>
-#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <cstring>
 
 #include "../Interfaces/LibraryManager.hpp"
+#include "../Utils/AuthPool.hpp"
 
-LibraryManager::LibraryManager() : books(), users(), transactions() {}
+namespace {
+    // Row from a batched lookup, or an empty one for an id that no longer exists.
+    template <typename Dto>
+    const Dto& JoinedRow(const std::unordered_map<int, Dto>& rows, int id) {
+        static const Dto missing{};
+        auto it = rows.find(id);
+        return it != rows.end() ? it->second : missing;
+    }
+
+    template <typename Member>
+    std::vector<int> JoinIds(const std::vector<TransactionsDto>& rows, Member member) {
+        std::vector<int> ids;
+        ids.reserve(rows.size());
+        for (const auto& row : rows) ids.push_back(row.*member);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    }
+
+    // Listings fetch one row past the page to learn whether another page
+    // follows. Trims that row and returns the cursor for the next page, or
+    // an empty string when this page is the last.
+    template <typename Row>
+    std::string TrimPage(std::vector<Row>& rows, size_t pageSize, int Row::*id) {
+        if (rows.size() <= pageSize) return "";
+        rows.resize(pageSize);
+        return Utils::EncodeCursor({static_cast<uint64_t>(rows.back().*id)});
+    }
+
+    bool DecodeAfterId(const std::string& cursor, int& afterId) {
+        afterId = 0;
+        if (cursor.empty()) return true;
+        std::vector<uint64_t> key;
+        if (!Utils::DecodeCursor(cursor, 1, key) || key[0] > INT_MAX) return false;
+        afterId = static_cast<int>(key[0]);
+        return true;
+    }
+
+    void AppendNextPage(ResponseBuffer& out, UserCommand command, const Utils::PageRequest& page,
+                        const std::string& cursor) {
+        if (cursor.empty()) return;
+        out << "More results: enter '" << static_cast<int>(command) << " " << cursor;
+        if (page.pageSize != Utils::DefaultPageSize) out << " " << page.pageSize;
+        out << "' for the next page.\n";
+    }
+}
+
+LibraryManager::LibraryManager()
+    : books(), users(), transactions(),
+      journal("./resources/database/library.journal", books, users, transactions) {}
+
+// Menu text never changes, so it is built once and shared by every reply.
+const std::string& LibraryManager::GetCurrentMenu(const Session& session) {
+    static const std::string initialMenu = "Enter a command (1=Login, 2=Register, exit=Exit): ";
+    static const std::string userManagementMenu =
+        "\nUser Management Commands:\n"
+        "11. Activate User\n"
+        "12. Deactivate User\n"
+        "13. Delete User\n"
+        "14. Change to Admin\n"
+        "15. Change to User\n"
+        "16. View User Transactions\n"
+        "17. View All Transactions\n"
+        "18. Hard Delete User\n"
+        "21. View Auth Metrics\n"
+        "0. Back to Main Menu\n"
+        "Enter command number: ";
+    static const std::string noMenu;
 
-std::string LibraryManager::GetCurrentMenu(const Session& session) {
     switch (session.currentMenu) {
         case MenuType::INITIAL:
-            return "Enter a command (1=Login, 2=Register, exit=Exit): ";
+            return initialMenu;
             
         case MenuType::MAIN:
             return GetMainMenu(session.user.Type);
             
         case MenuType::USER_MANAGEMENT:
-            return "\nUser Management Commands:\n"
-                   "11. Activate User\n"
-                   "12. Deactivate User\n"
-                   "13. Delete User\n"
-                   "14. Change to Admin\n"
-                   "15. Change to User\n"
-                   "16. View User Transactions\n"
-                   "17. View All Transactions\n"
-                   "18. Hard Delete User\n"
-                   "0. Back to Main Menu\n"
-                   "Enter command number: ";
+            return userManagementMenu;
             
         default:
-            return "";
+            return noMenu;
     }
 }
 
-std::string LibraryManager::ProcessCommand(int clientId, const std::string& command) {
-    if (sessions.find(clientId) == sessions.end()) {
-        sessions[clientId] = Session{};
+void LibraryManager::ProcessCommand(int clientId, const std::string& command, ResponseBuffer& out) {
+    if (++commandCount % EvictionInterval == 0) {
+        sessions.EvictIdle(SessionIdleTimeout);
     }
-    
-    auto& session = sessions[clientId];
+
+    // Held until the reply is built so one client's commands run one at a time.
+    auto handle = sessions.Acquire(clientId);
+    auto& session = *handle;
     
     if (session.state == SessionState::INITIAL) {
         if (command == "1") {
             session.state = SessionState::LOGIN_EMAIL;
-            return "Enter email:";
+            out << "Enter email:";
+            return;
         } else if (command == "2") {
             session.state = SessionState::REGISTER_FIRST_NAME;
-            return "Enter first name:";
+            out << "Enter first name:";
+            return;
         } else if (command == "exit") {
             ClearSession(clientId);
-            return "Goodbye!";
+            out << "Goodbye!";
+            return;
         }
-        return "Invalid command.\n" + GetCurrentMenu(session);
+        out << "Invalid command.\n" << GetCurrentMenu(session);
+        return;
     }
     
     if (!session.isAuthenticated) {
         if (session.state == SessionState::LOGIN_EMAIL || 
             session.state == SessionState::LOGIN_PASSWORD) {
-            return HandleLogin(clientId, command);
+            return HandleLogin(session, command, out);
         } else {
-            return HandleRegistration(clientId, command);
+            return HandleRegistration(session, command, out);
         }
     }
     
     switch (session.state) {
-        case SessionState::WAITING_SEARCH_TERM:
+        case SessionState::WAITING_SEARCH_TERM: {
             session.state = SessionState::AUTHENTICATED;
-            return HandleBookSearch(command);
+            session.searchTerm = command;
+            Utils::PageRequest page;
+            page.pageSize = session.searchPageSize;
+            return HandleBookSearch(command, page, out);
+        }
             
         case SessionState::WAITING_BOOK_ID:
             session.state = SessionState::AUTHENTICATED;
             if (session.lastCommand == UserCommand::BORROW_BOOK) {
-                return HandleBorrowBook(clientId, command);
+                return HandleBorrowBook(session, command, out);
             } else if (session.lastCommand == UserCommand::RETURN_BOOK) {
-                return HandleReturnBook(clientId, command);
+                return HandleReturnBook(session, command, out);
             }
             else if (session.lastCommand == UserCommand::REMOVE_BOOK) {
-                return HandleRemoveBook(command);
+                return HandleRemoveBook(command, out);
             }
-            return "Invalid state";
+            out << "Invalid state";
+            return;
             
         case SessionState::WAITING_BOOK_NAME:
         case SessionState::WAITING_BOOK_ISBN:
         case SessionState::WAITING_BOOK_AUTHOR:
         case SessionState::WAITING_BOOK_PUBLISHER:
         case SessionState::WAITING_BOOK_COPIES:
-            return HandleAddBook(clientId, command);
+            return HandleAddBook(session, command, out);
             
         case SessionState::WAITING_CATEGORY_NAME:
         case SessionState::WAITING_CATEGORY_DESCRIPTION:
-            return HandleAddCategory(clientId, command);
+            return HandleAddCategory(session, command, out);
 
         case SessionState::WAITING_USER_ID:
             //if (session.state == SessionState::WAITING_USER_ID) {
             switch (session.lastCommand) {
                 case UserCommand::ACTIVATE_USER:
-                    return HandleUserStatusChange(clientId, command, UserStatus::UserStatus_ACTIVE);
+                    return HandleUserStatusChange(session, command, UserStatus::UserStatus_ACTIVE, out);
                 case UserCommand::DEACTIVATE_USER:
-                    return HandleUserStatusChange(clientId, command, UserStatus::UserStatus_INACTIVE);
+                    return HandleUserStatusChange(session, command, UserStatus::UserStatus_INACTIVE, out);
                 case UserCommand::DELETE_USER:
-                    return HandleUserStatusChange(clientId, command, UserStatus::UserStatus_DELETED);
+                    return HandleUserStatusChange(session, command, UserStatus::UserStatus_DELETED, out);
                 case UserCommand::CHANGE_TO_ADMIN:
-                    return HandleUserTypeChange(clientId, command, UserType::UserType_ADMIN);
+                    return HandleUserTypeChange(session, command, UserType::UserType_ADMIN, out);
                 case UserCommand::CHANGE_TO_USER:
-                    return HandleUserTypeChange(clientId, command, UserType::UserType_USERS);
+                    return HandleUserTypeChange(session, command, UserType::UserType_USERS, out);
                 case UserCommand::VIEW_USER_TRANSACTIONS:
-                    return HandleViewUserTransactions(clientId, command);
+                    return HandleViewUserTransactions(session, command, out);
                 case UserCommand::VIEW_ALL_TRANSACTIONS:
-                    return HandleViewAllTransactions();
+                    return HandleViewAllTransactions(Utils::PageRequest{}, out);
                 case UserCommand::HARD_DELETE_USER:
-                    return HandleHardDeleteUser(clientId, command);
+                    return HandleHardDeleteUser(session, command, out);
                 case UserCommand::HARD_DELETE_USER_CONFIRMED:
-                    return HandleHardDeleteUserConfirmed(clientId, command);
+                    return HandleHardDeleteUserConfirmed(session, command, out);
                 default:
-                    return "Invalid command";
+                    out << "Invalid command";
+                    return;
                     }
                 //}
             
             
             case SessionState::WAITING_NEW_PASSWORD:
-                return HandleChangePassword(clientId, command);
+                return HandleChangePassword(session, command, out);
 
         case SessionState::AUTHENTICATED:
             try {
                 int cmd = std::stoi(command);
                 session.lastCommand = static_cast<UserCommand>(cmd);
+                // Listing commands take an optional cursor and page size.
+                auto page = Utils::ParsePageRequest(command);
                 switch (session.lastCommand) {
                     case UserCommand::SEARCH_BOOKS:
+                        if (!page.cursor.empty() && !session.searchTerm.empty()) {
+                            return HandleBookSearch(session.searchTerm, page, out);
+                        }
+                        session.searchPageSize = page.pageSize;
                         session.state = SessionState::WAITING_SEARCH_TERM;
-                        return "Enter search term:";
+                        out << "Enter search term:";
+                        return;
                         
                     case UserCommand::BORROW_BOOK:
                         session.state = SessionState::WAITING_BOOK_ID;
-                        return "Enter book ID to borrow:";
+                        out << "Enter book ID to borrow:";
+                        return;
                         
                     case UserCommand::RETURN_BOOK:
                         session.state = SessionState::WAITING_BOOK_ID;
-                        return "Enter book ID to return:";
+                        out << "Enter book ID to return:";
+                        return;
                         
                     case UserCommand::VIEW_BORROWED:
-                        return ViewBorrowedBooks(clientId);
+                        return ViewBorrowedBooks(session, page, out);
                         
                     case UserCommand::VIEW_RETURNED:
-                        return ViewReturnedBooks(clientId);
+                        return ViewReturnedBooks(session, page, out);
                         
                     case UserCommand::ADD_BOOK:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_BOOK_NAME;
-                        return "Enter book name:";
+                        out << "Enter book name:";
+                        return;
                         
                     case UserCommand::REMOVE_BOOK:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_BOOK_ID;
-                        return "Enter book ID to remove:";
+                        out << "Enter book ID to remove:";
+                        return;
                         
                     case UserCommand::ADD_CATEGORY:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_CATEGORY_NAME;
-                        return "Enter category name:";
+                        out << "Enter category name:";
+                        return;
                         
                     case UserCommand::MANAGE_USERS:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
-                        return HandleManageUsers();
+                        return HandleManageUsers(page, out);
 
                     case UserCommand::ACTIVATE_USER:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_USER_ID;
-                        return "Enter user ID to activate:";
+                        out << "Enter user ID to activate:";
+                        return;
                         
                     case UserCommand::DEACTIVATE_USER:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_USER_ID;
-                        return "Enter user ID to deactivate:";
+                        out << "Enter user ID to deactivate:";
+                        return;
                         
                     case UserCommand::DELETE_USER:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_USER_ID;
-                        return "Enter user ID to delete:";
+                        out << "Enter user ID to delete:";
+                        return;
                     
                     case UserCommand::CHANGE_TO_ADMIN:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_USER_ID;
-                        return "Enter user ID to change to Admin:";
+                        out << "Enter user ID to change to Admin:";
+                        return;
 
                     case UserCommand::CHANGE_TO_USER:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_USER_ID;
-                        return "Enter user ID to change to User:";
+                        out << "Enter user ID to change to User:";
+                        return;
 
                     case UserCommand::VIEW_USER_TRANSACTIONS:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_USER_ID;
-                        return "Enter user ID to view transactions:";
+                        out << "Enter user ID to view transactions:";
+                        return;
 
                     case UserCommand::VIEW_ALL_TRANSACTIONS:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
+                        }
+                        return HandleViewAllTransactions(page, out);
+
+                    case UserCommand::VIEW_AUTH_METRICS:
+                        if (session.user.Type != UserType::UserType_ADMIN) {
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
-                        return HandleViewAllTransactions();
+                        return HandleViewAuthMetrics(out);
 
                     case UserCommand::HARD_DELETE_USER:
                         if (session.user.Type != UserType::UserType_ADMIN) {
-                            return "Access denied. Admin privileges required.";
+                            out << "Access denied. Admin privileges required.";
+                            return;
                         }
                         session.state = SessionState::WAITING_USER_ID;
-                        return "Enter user ID to hard delete (permanent):";
+                        out << "Enter user ID to hard delete (permanent):";
+                        return;
 
                     case UserCommand::CHANGE_PASSWORD:
                         session.state = SessionState::WAITING_NEW_PASSWORD;
-                        return "Enter new password:";
+                        out << "Enter new password:";
+                        return;
 
                     case UserCommand::LOGOUT:
                         ClearSession(clientId);
-                        return "Logged out successfully.";
+                        out << "Logged out successfully.";
+                        return;
                         
                     default:
-                        return GetMainMenu(session.user.Type);
+                        out << GetMainMenu(session.user.Type);
+                        return;
                 }
             } catch (...) {
-                return GetMainMenu(session.user.Type);
+                out.Clear();  // drop whatever a failed handler had written
+                out << GetMainMenu(session.user.Type);
+                return;
             }
             
             
         default:
-            return "Invalid state";
+            out << "Invalid state";
+            return;
     }
 }
 
-std::string LibraryManager::GetMainMenu(UserType userType) {
-    std::stringstream ss;
-    ss << "\nAvailable commands:\n"
-       << "1. Search Books\n"
-       << "2. Borrow Book\n"
-       << "3. Return Book\n"
-       << "4. View Borrowed Books\n"
-       << "5. View Returned Books\n";
-    
-    if (userType == UserType::UserType_ADMIN) {
-        ss << "6. Add Book\n"
-           << "7. Remove Book\n"
-           << "8. Add Category\n"
-           << "9. Manage Users\n";
-    }
-    
-    ss << "10. Logout\n"
-        << "20. Change Password\n"
-        << "Enter command number: ";
-    
-    return ss.str();
+const std::string& LibraryManager::GetMainMenu(UserType userType) {
+    static const std::string userCommands =
+        "\nAvailable commands:\n"
+        "1. Search Books\n"
+        "2. Borrow Book\n"
+        "3. Return Book\n"
+        "4. View Borrowed Books\n"
+        "5. View Returned Books\n";
+    static const std::string closingCommands =
+        "10. Logout\n"
+        "20. Change Password\n"
+        "Enter command number: ";
+    static const std::string userMenu = userCommands + closingCommands;
+    static const std::string adminMenu = userCommands +
+        "6. Add Book\n"
+        "7. Remove Book\n"
+        "8. Add Category\n"
+        "9. Manage Users\n" + closingCommands;
+
+    return userType == UserType::UserType_ADMIN ? adminMenu : userMenu;
 }
 
-std::string LibraryManager::HandleLogin(int clientId, const std::string& input) {
-    auto& session = sessions[clientId];
-    
+void LibraryManager::HandleLogin(Session& session, const std::string& input, ResponseBuffer& out) {
     if (session.state == SessionState::LOGIN_EMAIL) {
         session.email = input;
         session.state = SessionState::LOGIN_PASSWORD;
-        return "Enter password:";
+        out << "Enter password:";
+        return;
     }
     
     if (session.state == SessionState::LOGIN_PASSWORD) {
@@ -286,55 +399,60 @@ std::string LibraryManager::HandleLogin(int clientId, const std::string& input)
             session.user = users.GetUserByEmail(session.email);
             session.state = SessionState::AUTHENTICATED;
             
-            auto borrowedBooks = users.GetBorrowedBooks(session.user.UserId);
-            std::stringstream ss;
-            ss << "Welcome " << session.user.FirstName << " " << session.user.LastName << "!\n";
-            ss << "You currently have " << borrowedBooks.size() << " book(s) borrowed.\n\n";
-            ss << GetMainMenu(session.user.Type);
-            return ss.str();
+            size_t borrowedCount = transactions.CountTransactionsByUserAndStatus(
+                session.user.UserId, BorrowStatus::BorrowStatus_BORROWED);
+            out << "Welcome " << session.user.FirstName << " " << session.user.LastName << "!\n";
+            out << "You currently have " << borrowedCount << " book(s) borrowed.\n\n";
+            out << GetMainMenu(session.user.Type);
+            return;
         }
         session.state = SessionState::INITIAL;
-        return "Login failed. " + result;
+        out << "Login failed. " << result;
+        return;
     }
     
-    return "Invalid login state";
+    out << "Invalid login state";
 }
 
-std::string LibraryManager::HandleRegistration(int clientId, const std::string& input) {
-    auto& session = sessions[clientId];
-    
+void LibraryManager::HandleRegistration(Session& session, const std::string& input, ResponseBuffer& out) {
     switch (session.state) {
         case SessionState::REGISTER_FIRST_NAME:
             session.firstName = input;
             session.state = SessionState::REGISTER_LAST_NAME;
-            return "Enter last name:";
+            out << "Enter last name:";
+            return;
             
         case SessionState::REGISTER_LAST_NAME:
             session.lastName = input;
             session.state = SessionState::REGISTER_ADDRESS;
-            return "Enter address:";
+            out << "Enter address:";
+            return;
             
         case SessionState::REGISTER_ADDRESS:
             session.address = input;
             session.state = SessionState::REGISTER_PHONE;
-            return "Enter phone number:";
+            out << "Enter phone number:";
+            return;
             
         case SessionState::REGISTER_PHONE:
             session.phoneNumber = input;
             session.state = SessionState::REGISTER_EMAIL;
-            return "Enter email:";
+            out << "Enter email:";
+            return;
             
         case SessionState::REGISTER_EMAIL:
             session.email = input;
             session.state = SessionState::REGISTER_PASSWORD;
-            return "Enter password:";
+            out << "Enter password:";
+            return;
             
         case SessionState::REGISTER_PASSWORD: {
             session.password = input;
 
             if (!ValidatePassword(session.password)) {
                 session.state = SessionState::REGISTER_PASSWORD;
-                return "Password must be at least 8 characters long.";
+                out << "Password must be at least 8 characters long.";
+                return;
             }
 
             UserDto newUser;
@@ -347,184 +465,251 @@ std::string LibraryManager::HandleRegistration(int clientId, const std::string&
             newUser.Status = UserStatus::UserStatus_ACTIVE;
             newUser.Type = UserType::UserType_USERS;
             
-            if (users.AddUser(newUser)) {
+            std::string result = users.AddUser(newUser);
+            if (result == "success") {
                 session.isAuthenticated = true;
                 session.state = SessionState::AUTHENTICATED;
-                return "Registration successful! Welcome " + session.firstName;
+                out << "Registration successful! Welcome " << session.firstName;
+                return;
             }
             
             session.state = SessionState::INITIAL;
-            return "Registration failed. Email might already exist.";
+            if (result == Users::ServerBusy) {
+                out << result;
+                return;
+            }
+            out << "Registration failed. Email might already exist.";
+            return;
         }
         
         default:
             session.state = SessionState::INITIAL;
-            return "Invalid registration state";
+            out << "Invalid registration state";
+            return;
     }
 }
 
 void LibraryManager::ClearSession(int clientId) {
-    sessions.erase(clientId);
+    sessions.Erase(clientId);
 }
 
-std::string LibraryManager::HandleBookSearch(const std::string& searchTerm) {
-    auto results = books.SearchBooks(searchTerm);
+void LibraryManager::HandleBookSearch(const std::string& searchTerm, const Utils::PageRequest& page, ResponseBuffer& out) {
+    // A search cursor is the (score, book id) of the last result shown.
+    Books::SearchPosition position{};
+    const Books::SearchPosition* after = nullptr;
+    if (!page.cursor.empty()) {
+        std::vector<uint64_t> key;
+        if (!Utils::DecodeCursor(page.cursor, 2, key) || key[1] > INT_MAX) {
+            out << "Invalid cursor.";
+            return;
+        }
+        std::memcpy(&position.score, &key[0], sizeof(position.score));
+        position.bookId = static_cast<int>(key[1]);
+        after = &position;
+    }
+
+    auto results = books.SearchBooks(searchTerm, page.pageSize + 1, after);
     if (results.empty()) {
-        return "No books found.";
+        out << (after != nullptr ? "No more books found." : "No books found.");
+        return;
+    }
+    std::string cursor;
+    if (results.size() > page.pageSize) {
+        results.resize(page.pageSize);
+        uint64_t scoreBits;
+        std::memcpy(&scoreBits, &results.back().score, sizeof(scoreBits));
+        cursor = Utils::EncodeCursor({scoreBits, static_cast<uint64_t>(results.back().book.BookId)});
+    }
+
+    // One category lookup for the whole page rather than one per row.
+    std::vector<int> categoryIds;
+    for (const auto& result : results) {
+        categoryIds.insert(categoryIds.end(), result.book.CategoryIds.begin(), result.book.CategoryIds.end());
+    }
+    std::sort(categoryIds.begin(), categoryIds.end());
+    categoryIds.erase(std::unique(categoryIds.begin(), categoryIds.end()), categoryIds.end());
+    std::unordered_map<int, CategoryDto> pageCategories;
+    for (auto& category : categories.GetCategoriesByIds(categoryIds)) {
+        pageCategories.emplace(category.CategoryId, std::move(category));
     }
 
-    std::stringstream ss;
-    ss << "\nSearch Results:\n";
+    out << "\nSearch Results:\n";
     for (const auto& result : results) {
-        ss << "ID: " << result.book.BookId
+        out << "ID: " << result.book.BookId
            << ", Title: " << result.book.Name
            << ", Author: " << result.book.Author
-           << ", Copies: " << result.book.NoOfCopies << "\n";
+           << ", Copies: " << result.book.NoOfCopies;
+        bool first = true;
+        for (int categoryId : result.book.CategoryIds) {
+            const auto& category = JoinedRow(pageCategories, categoryId);
+            if (category.CategoryId == 0) continue;
+            out << (first ? ", Categories: " : ", ") << category.Name;
+            first = false;
+        }
+        out << "\n";
     }
-    return ss.str();
+    AppendNextPage(out, UserCommand::SEARCH_BOOKS, page, cursor);
 }
 
-std::string LibraryManager::HandleBorrowBook(int clientId, const std::string& bookId) {
-    auto& session = sessions[clientId];
+void LibraryManager::HandleBorrowBook(Session& session, const std::string& bookId, ResponseBuffer& out) {
     try {
         auto book = books.GetBooksById(std::stoi(bookId));
         if (book.BookId == 0) {
-            return "Book not found.";
+            out << "Book not found.";
+            return;
         }
         if (book.NoOfCopies <= 0) {
-            return "No copies available.";
+            out << "No copies available.";
+            return;
         }
 
-        TransactionsDto transaction;
+        TransactionsDto transaction{};
         transaction.UserId = session.user.UserId;
         transaction.BookId = book.BookId;
-        transaction.CreatedDate = std::time(nullptr);
-        transaction.BorrowDate = std::time(nullptr);
         transaction.Status = BorrowStatus::BorrowStatus_BORROWED;
 
-        if (transactions.AddTransaction(transaction) == "success") {
-            books.RemoveBookCopies(book.BookId, 1);
-            users.AddBorrowedBook(session.user.UserId, bookId);
-            return "Book borrowed successfully.";
+        // The loan and the copy commit together; the copy is reserved under its
+        // row lock, so the last one cannot go to two borrowers.
+        UnitOfWork work;
+        work.AddTransaction(transaction);
+        work.ReserveCopy(book.BookId);
+
+        if (journal.Commit(work)) {
+            out << "Book borrowed successfully.";
+            return;
+        }
+        if (work.OutOfStock()) {
+            out << "No copies available.";
+            return;
         }
     } catch (const std::exception& e) {
-        return "Failed to borrow book: " + std::string(e.what());
+        out << "Failed to borrow book: " << e.what();
+        return;
     }
-    return "Failed to borrow book.";
+    out << "Failed to borrow book.";
 }
 
-std::string LibraryManager::HandleReturnBook(int clientId, const std::string& bookId) {
-    auto& session = sessions[clientId];
+void LibraryManager::HandleReturnBook(Session& session, const std::string& bookId, ResponseBuffer& out) {
     try
     {
         auto book = books.GetBooksById(std::stoi(bookId));
         if (book.BookId == 0) {
-            return "Book not found.";
+            out << "Book not found.";
+            return;
         }
 
-        auto userTransactions = transactions.GetTransactionsByUserId(session.user.UserId);
-        auto it = std::find_if(userTransactions.begin(), userTransactions.end(),
-            [&](const TransactionsDto& t) {
-                return t.BookId == book.BookId && 
-                    t.Status == BorrowStatus::BorrowStatus_BORROWED;
-            });
-
-        if (it == userTransactions.end()) {
-            return "You haven't borrowed this book.";
+        auto loan = transactions.GetBorrowedTransactionsByUserAndBookId(session.user.UserId, book.BookId);
+        if (loan.TransactionId == 0) {
+            out << "You haven't borrowed this book.";
+            return;
         }
 
-        it->Status = BorrowStatus::BorrowStatus_RETURNED;
-        it->ReturnDate = std::time(nullptr);
-        it->ActualReturnDate = std::time(nullptr);
+        UnitOfWork work;
+        work.UpdateTransaction(loan.TransactionId, [](TransactionsDto& row) {
+            if (row.Status != BorrowStatus::BorrowStatus_BORROWED) return false;
+            row.Status = BorrowStatus::BorrowStatus_RETURNED;
+            row.ReturnDate = std::time(nullptr);
+            row.ActualReturnDate = std::time(nullptr);
+            return true;
+        });
+        work.ReleaseCopy(book.BookId);
 
-        if (transactions.UpdateTransaction(*it) == "success") {
-            books.AddBookCopies(book.BookId, 1);
-            users.AddReturnedBook(session.user.UserId, std::to_string(book.BookId));
-            return "Book returned successfully.";
+        if (journal.Commit(work)) {
+            out << "Book returned successfully.";
+            return;
         }
     }
     catch(const std::exception& e)
     {
-        return "Failed to return book: " + std::string(e.what());
+        out << "Failed to return book: " << e.what();
+        return;
     }
     
-    return "Failed to return book.";
+    out << "Failed to return book.";
 }
 
-std::string LibraryManager::ViewBorrowedBooks(int clientId) {
-    auto& session = sessions[clientId];
-    auto borrowedBooks = users.GetBorrowedBooks(session.user.UserId);
+void LibraryManager::ViewBorrowedBooks(Session& session, const Utils::PageRequest& page, ResponseBuffer& out) {
+    int afterId;
+    if (!DecodeAfterId(page.cursor, afterId)) {
+        out << "Invalid cursor.";
+        return;
+    }
+    auto loans = transactions.GetTransactionsByUserAndStatus(session.user.UserId, BorrowStatus::BorrowStatus_BORROWED,
+                                                             afterId, page.pageSize + 1);
     
-    if (borrowedBooks.empty()) {
-        return "No books currently borrowed.";
+    if (loans.empty()) {
+        out << (afterId > 0 ? "No more books." : "No books currently borrowed.");
+        return;
     }
+    std::string cursor = TrimPage(loans, page.pageSize, &TransactionsDto::TransactionId);
 
-    std::stringstream ss;
-    ss << "\nCurrently Borrowed Books:\n";
-    for (const auto& bookId : borrowedBooks) {
-        auto book = books.GetBooksById(std::stoi(bookId));
-        auto transaction = transactions.GetBorrowedTransactionsByUserAndBookId(session.user.UserId, book.BookId);
+    auto loanBooks = books.GetBooksByIds(JoinIds(loans, &TransactionsDto::BookId));
+    out << "\nCurrently Borrowed Books:\n";
+    for (const auto& transaction : loans) {
+        const auto& book = JoinedRow(loanBooks, transaction.BookId);
 
-        std::time_t dueDate = transaction.DueDate;
-        std::tm* tm = std::gmtime(&dueDate);
-
-        ss << "Book ID: " << book.BookId 
+        out << "Book ID: " << transaction.BookId 
            << ", Title: " << book.Name
            << ", Author: " << book.Author
-           << ", Due: " << std::put_time(tm, "%Y-%m-%d %H:%M:%S UTC") << "\n";
+           << ", Due: " << Utils::Utc{transaction.DueDate} << "\n";
     }
-    return ss.str();
+    AppendNextPage(out, UserCommand::VIEW_BORROWED, page, cursor);
 }
 
-std::string LibraryManager::ViewReturnedBooks(int clientId) {
-    auto& session = sessions[clientId];
-    auto returnedBooks = users.GetReturnedBooks(session.user.UserId);
+void LibraryManager::ViewReturnedBooks(Session& session, const Utils::PageRequest& page, ResponseBuffer& out) {
+    int afterId;
+    if (!DecodeAfterId(page.cursor, afterId)) {
+        out << "Invalid cursor.";
+        return;
+    }
+    auto loans = transactions.GetTransactionsByUserAndStatus(session.user.UserId, BorrowStatus::BorrowStatus_RETURNED,
+                                                             afterId, page.pageSize + 1);
     
-    if (returnedBooks.empty()) {
-        return "No books in return history.";
+    if (loans.empty()) {
+        out << (afterId > 0 ? "No more books." : "No books in return history.");
+        return;
     }
+    std::string cursor = TrimPage(loans, page.pageSize, &TransactionsDto::TransactionId);
 
-    std::stringstream ss;
-    ss << "\nReturn History:\n";
-    for (const auto& bookId : returnedBooks) {
-        auto book = books.GetBooksById(std::stoi(bookId));
-        auto transaction = transactions.GetReturnedTransactionsByUserAndBookId(session.user.UserId, book.BookId);
+    auto loanBooks = books.GetBooksByIds(JoinIds(loans, &TransactionsDto::BookId));
+    out << "\nReturn History:\n";
+    for (const auto& transaction : loans) {
+        const auto& book = JoinedRow(loanBooks, transaction.BookId);
 
-        std::time_t returnDate = transaction.ReturnDate;
-        std::tm* tm = std::gmtime(&returnDate);
-
-        ss << "Book ID: " << book.BookId 
+        out << "Book ID: " << transaction.BookId 
            << ", Title: " << book.Name
            << ", Author: " << book.Author
-           << ", Returned: " << std::put_time(tm, "%Y-%m-%d %H:%M:%S UTC") << "\n";
+           << ", Returned: " << Utils::Utc{transaction.ReturnDate} << "\n";
     }
-    return ss.str();
+    AppendNextPage(out, UserCommand::VIEW_RETURNED, page, cursor);
 }
 
 // Admin Methods
-std::string LibraryManager::HandleAddBook(int clientId, const std::string& input) {
-    auto& session = sessions[clientId];
-
+void LibraryManager::HandleAddBook(Session& session, const std::string& input, ResponseBuffer& out) {
     switch (session.state) {
         case SessionState::WAITING_BOOK_NAME:
             session.bookName = input;
             session.state = SessionState::WAITING_BOOK_ISBN;
-            return "Enter ISBN:";
+            out << "Enter ISBN:";
+            return;
 
         case SessionState::WAITING_BOOK_ISBN:
             session.bookIsbn = input;
             session.state = SessionState::WAITING_BOOK_AUTHOR;
-            return "Enter author:";
+            out << "Enter author:";
+            return;
 
         case SessionState::WAITING_BOOK_AUTHOR:
             session.bookAuthor = input;
             session.state = SessionState::WAITING_BOOK_PUBLISHER;
-            return "Enter publisher:";
+            out << "Enter publisher:";
+            return;
 
         case SessionState::WAITING_BOOK_PUBLISHER:
             session.bookPublisher = input;
             session.state = SessionState::WAITING_BOOK_COPIES;
-            return "Enter number of copies:";
+            out << "Enter number of copies:";
+            return;
 
         case SessionState::WAITING_BOOK_COPIES:
             try {
@@ -539,37 +724,42 @@ std::string LibraryManager::HandleAddBook(int clientId, const std::string& input
                 
                 if (books.AddBook(newBook)) {
                     session.state = SessionState::AUTHENTICATED;
-                    return "Book added successfully!";
+                    out << "Book added successfully!";
+                    return;
                 }
                 
                 session.state = SessionState::AUTHENTICATED;
-                return "Failed to add book.";
+                out << "Failed to add book.";
+                return;
             } catch (const std::exception& e) {
-                return "Invalid number of copies. Please enter a number.";
+                out << "Invalid number of copies. Please enter a number.";
+                return;
             }
 
         default:
             session.state = SessionState::AUTHENTICATED;
-            return "Invalid state for adding book";
+            out << "Invalid state for adding book";
+            return;
     }
 }
 
-std::string LibraryManager::HandleRemoveBook(const std::string& bookId) {
+void LibraryManager::HandleRemoveBook(const std::string& bookId, ResponseBuffer& out) {
     if (books.RemoveBook(std::stoi(bookId))) {
-        return "Book removed successfully.";
+        out << "Book removed successfully.";
+        return;
     }
-    return "Failed to remove book.";
+    out << "Failed to remove book.";
 }
 
-std::string LibraryManager::HandleAddCategory(int clientId, const std::string& input) {
-    auto& session = sessions[clientId];
+void LibraryManager::HandleAddCategory(Session& session, const std::string& input, ResponseBuffer& out) {
     CategoryDto newCategory;
 
     switch (session.state) {
         case SessionState::WAITING_CATEGORY_NAME:
             session.categoryName = input;
             session.state = SessionState::WAITING_CATEGORY_DESCRIPTION;
-            return "Enter category description:";
+            out << "Enter category description:";
+            return;
 
         case SessionState::WAITING_CATEGORY_DESCRIPTION:
             session.categoryDescription = input;
@@ -579,65 +769,74 @@ std::string LibraryManager::HandleAddCategory(int clientId, const std::string& i
             
             if (categories.AddCategory(newCategory)) {
                 session.state = SessionState::AUTHENTICATED;
-                return "Category added successfully!";
+                out << "Category added successfully!";
+                return;
             }
             
             session.state = SessionState::AUTHENTICATED;
-            return "Failed to add category.";
+            out << "Failed to add category.";
+            return;
 
         default:
             session.state = SessionState::AUTHENTICATED;
-            return "Invalid state for adding category";
+            out << "Invalid state for adding category";
+            return;
     }
 }
 
 //add methods to manage users details disable account 
-std::string LibraryManager::HandleManageUsers() {
-    auto allUsers = users.GetAllUsers();
+void LibraryManager::HandleManageUsers(const Utils::PageRequest& page, ResponseBuffer& out) {
+    int afterId;
+    if (!DecodeAfterId(page.cursor, afterId)) {
+        out << "Invalid cursor.";
+        return;
+    }
+    auto allUsers = users.GetUsersPage(afterId, page.pageSize + 1);
+    std::string cursor = TrimPage(allUsers, page.pageSize, &UserDto::UserId);
     
-    std::stringstream ss;
-    ss << "\nUser Management:\n";
-    ss << "----------------------------------------\n";
-    ss << "Status: 1=Active, 2=Inactive, 3=Deleted\n";
-    ss << "Type: 0=Admin, 2=User\n\n";
+    out << "\nUser Management:\n"
+           "----------------------------------------\n"
+           "Status: 1=Active, 2=Inactive, 3=Deleted\n"
+           "Type: 0=Admin, 2=User\n\n";
     
     for (const auto& user : allUsers) {
-        ss << "ID: " << user.UserId 
+        out << "ID: " << user.UserId 
            << ", Name: " << user.FirstName << " " << user.LastName
            << ", Email: " << user.Email
            << ", Type: " << static_cast<int>(user.Type)
            << ", Status: " << static_cast<int>(user.Status) << "\n";
     }
+    AppendNextPage(out, UserCommand::MANAGE_USERS, page, cursor);
     
-    ss << "\nCommands:\n"
-       << "11. Activate User\n"
-       << "12. Deactivate User\n"
-       << "13. Delete User\n"
-       << "14. Change to Admin\n"
-       << "15. Change to User\n"
-       << "16. View User Transactions\n"
-       << "17. View All Transactions\n"
-       << "18. Hard Delete User (Permanent)\n"
-       << "0. Back to Main Menu\n";
-    
-    return ss.str();
+    out << "\nCommands:\n"
+           "11. Activate User\n"
+           "12. Deactivate User\n"
+           "13. Delete User\n"
+           "14. Change to Admin\n"
+           "15. Change to User\n"
+           "16. View User Transactions\n"
+           "17. View All Transactions\n"
+           "18. Hard Delete User (Permanent)\n"
+           "21. View Auth Metrics\n"
+           "0. Back to Main Menu\n";
 }
 
-std::string LibraryManager::HandleUserStatusChange(int clientId, const std::string& userId, UserStatus newStatus) {
-    auto& session = sessions[clientId];
+void LibraryManager::HandleUserStatusChange(Session& session, const std::string& userId, UserStatus newStatus, ResponseBuffer& out) {
     try {
         int id = std::stoi(userId);
         auto user = users.GetUserById(id);
         
         if (user.UserId == 0) {
             session.state = SessionState::AUTHENTICATED;
-            return "User not found.";
+            out << "User not found.";
+            return;
         }
         
         switch (user.Status) {
             case UserStatus::UserStatus_DELETED:
             session.state = SessionState::AUTHENTICATED;
-                return "Cannot modify deleted user account.";
+                out << "Cannot modify deleted user account.";
+                return;
                 
             case UserStatus::UserStatus_INACTIVE:
                 if (newStatus == UserStatus::UserStatus_DELETED) {
@@ -645,14 +844,16 @@ std::string LibraryManager::HandleUserStatusChange(int clientId, const std::stri
                 }
                 if (newStatus == UserStatus::UserStatus_INACTIVE) {
                     session.state = SessionState::AUTHENTICATED;
-                    return "User account is already inactive.";
+                    out << "User account is already inactive.";
+                    return;
                 }
                 break;
                 
             case UserStatus::UserStatus_ACTIVE:
                 if (newStatus == UserStatus::UserStatus_ACTIVE) {
                     session.state = SessionState::AUTHENTICATED;
-                    return "User account is already active.";
+                    out << "User account is already active.";
+                    return;
                 }
                 break;
 
@@ -681,52 +882,59 @@ std::string LibraryManager::HandleUserStatusChange(int clientId, const std::stri
                     status = "unknown";
                     break;
             }
-            return "User account " + status + " successfully.";
+            out << "User account " << status << " successfully.";
+            return;
         }
         session.state = SessionState::AUTHENTICATED;
-        return "Failed to update user status.";
+        out << "Failed to update user status.";
+        return;
     } catch (...) {
         session.state = SessionState::AUTHENTICATED;
-        return "Invalid user ID.";
+        out << "Invalid user ID.";
+        return;
     }
 }
 
 //This handles the change of user type
-std::string LibraryManager::HandleUserTypeChange(int clientId, const std::string& userId, UserType newType) {
-    auto& session = sessions[clientId];
-    
+void LibraryManager::HandleUserTypeChange(Session& session, const std::string& userId, UserType newType, ResponseBuffer& out) {
     try {
         int id = std::stoi(userId);
         
         if (id == session.user.UserId) {
             session.state = SessionState::AUTHENTICATED;
-            return "Cannot modify your own user type.";
+            out << "Cannot modify your own user type.";
+            return;
         }
         
         auto user = users.GetUserById(id);
         if (user.UserId == 0) {
             session.state = SessionState::AUTHENTICATED;
-            return "User not found.";
+            out << "User not found.";
+            return;
         }
         
         if (newType != UserType::UserType_ADMIN && newType != UserType::UserType_USERS) {
             session.state = SessionState::AUTHENTICATED;
-            return "Can only change between Admin and User types.";
+            out << "Can only change between Admin and User types.";
+            return;
         }
         
         if (user.Type == newType) {
             session.state = SessionState::AUTHENTICATED;
-            return "User is already of this type.";
+            out << "User is already of this type.";
+            return;
         }
         
         if (user.Status == UserStatus::UserStatus_DELETED) {
             session.state = SessionState::AUTHENTICATED;
-            return "Cannot modify deleted user account.";
+            out << "Cannot modify deleted user account.";
+            return;
         }
         
         if (user.Status == UserStatus::UserStatus_INACTIVE) {
             session.state = SessionState::AUTHENTICATED;
-            return "Cannot modify inactive user account.";
+            out << "Cannot modify inactive user account.";
+            return;
         }
         
         user.Type = newType;
@@ -734,150 +942,175 @@ std::string LibraryManager::HandleUserTypeChange(int clientId, const std::string
         
         if (users.UpdateUser(user)) {
             session.state = SessionState::AUTHENTICATED;
-            std::string type = (newType == UserType::UserType_ADMIN) ? "Administrator" : "User";
-            return "User type changed to " + type + " successfully.";
+            const char* type = (newType == UserType::UserType_ADMIN) ? "Administrator" : "User";
+            out << "User type changed to " << type << " successfully.";
+            return;
         }
         
         session.state = SessionState::AUTHENTICATED;
-        return "Failed to update user type.";
+        out << "Failed to update user type.";
+        return;
     } catch (...) {
         session.state = SessionState::AUTHENTICATED;
-        return "Invalid user ID.";
+        out << "Invalid user ID.";
+        return;
     }
 }
 
-std::string LibraryManager::HandleViewUserTransactions(int clientId, const std::string& userId) {
-    auto& session = sessions[clientId];
+void LibraryManager::HandleViewUserTransactions(Session& session, const std::string& userId, ResponseBuffer& out) {
     try {
         int id = std::stoi(userId);
         auto user = users.GetUserById(id);
         if (user.UserId == 0) {
             session.state = SessionState::AUTHENTICATED;
-            return "User not found.";
+            out << "User not found.";
+            return;
         }
 
         auto userTransactions = transactions.GetTransactionsByUserId(id);
         if (userTransactions.empty()) {
-            return "No transactions found for user.";
+            out << "No transactions found for user.";
+            return;
         }
 
-        std::stringstream ss;
-        ss << "\nTransactions for " << user.FirstName << " " << user.LastName << ":\n";
-        ss << "----------------------------------------\n";
+        auto transactionBooks = books.GetBooksByIds(JoinIds(userTransactions, &TransactionsDto::BookId));
+        out << "\nTransactions for " << user.FirstName << " " << user.LastName << ":\n";
+        out << "----------------------------------------\n";
         
         for (const auto& trans : userTransactions) {
-            auto book = books.GetBooksById(trans.BookId);
-            std::tm* borrowTm = std::gmtime(&trans.BorrowDate);
-            std::string status = (trans.Status == BorrowStatus::BorrowStatus_BORROWED) ? "Borrowed" : "Returned";
+            const auto& book = JoinedRow(transactionBooks, trans.BookId);
+            const char* status = (trans.Status == BorrowStatus::BorrowStatus_BORROWED) ? "Borrowed" : "Returned";
             
-            ss << "Book: " << book.Name 
+            out << "Book: " << book.Name 
                << "\nStatus: " << status
-               << "\nBorrowed: " << std::put_time(borrowTm, "%Y-%m-%d %H:%M:%S UTC");
+               << "\nBorrowed: " << Utils::Utc{trans.BorrowDate};
             
             if (trans.Status == BorrowStatus::BorrowStatus_RETURNED) {
-                std::tm* returnTm = std::gmtime(&trans.ReturnDate);
-                ss << "\nReturned: " << std::put_time(returnTm, "%Y-%m-%d %H:%M:%S UTC");
+                out << "\nReturned: " << Utils::Utc{trans.ReturnDate};
             }
-            ss << "\n----------------------------------------\n";
+            out << "\n----------------------------------------\n";
         }
         session.state = SessionState::AUTHENTICATED;
-        return ss.str();
     } catch (...) {
+        out.Clear();
         session.state = SessionState::AUTHENTICATED;
-        return "Invalid user ID.";
+        out << "Invalid user ID.";
+        return;
     }
 }
 
-std::string LibraryManager::HandleViewAllTransactions() {
-    auto allTransactions = transactions.GetAllTransactions();
+void LibraryManager::HandleViewAllTransactions(const Utils::PageRequest& page, ResponseBuffer& out) {
+    int afterId;
+    if (!DecodeAfterId(page.cursor, afterId)) {
+        out << "Invalid cursor.";
+        return;
+    }
+    auto allTransactions = transactions.GetTransactionsPage(afterId, page.pageSize + 1);
     if (allTransactions.empty()) {
-        return "No transactions found.";
+        out << (afterId > 0 ? "No more transactions." : "No transactions found.");
+        return;
     }
+    std::string cursor = TrimPage(allTransactions, page.pageSize, &TransactionsDto::TransactionId);
+
+    // Resolve each distinct user and book once rather than once per row.
+    auto transactionUsers = users.GetUsersByIds(JoinIds(allTransactions, &TransactionsDto::UserId));
+    auto transactionBooks = books.GetBooksByIds(JoinIds(allTransactions, &TransactionsDto::BookId));
 
-    std::stringstream ss;
-    ss << "\nAll Library Transactions:\n";
-    ss << "----------------------------------------\n";
+    out << "\nAll Library Transactions:\n";
+    out << "----------------------------------------\n";
     
     for (const auto& trans : allTransactions) {
-        auto user = users.GetUserById(trans.UserId);
-        auto book = books.GetBooksById(trans.BookId);
-        std::tm* borrowTm = std::gmtime(&trans.BorrowDate);
-        std::string status = (trans.Status == BorrowStatus::BorrowStatus_BORROWED) ? "Borrowed" : "Returned";
+        const auto& user = JoinedRow(transactionUsers, trans.UserId);
+        const auto& book = JoinedRow(transactionBooks, trans.BookId);
+        const char* status = (trans.Status == BorrowStatus::BorrowStatus_BORROWED) ? "Borrowed" : "Returned";
         
-        ss << "User: " << user.FirstName << " " << user.LastName
+        out << "User: " << user.FirstName << " " << user.LastName
            << "\nBook: " << book.Name 
            << "\nStatus: " << status
-           << "\nBorrowed: " << std::put_time(borrowTm, "%Y-%m-%d %H:%M:%S UTC");
+           << "\nBorrowed: " << Utils::Utc{trans.BorrowDate};
         
         if (trans.Status == BorrowStatus::BorrowStatus_RETURNED) {
-            std::tm* returnTm = std::gmtime(&trans.ReturnDate);
-            ss << "\nReturned: " << std::put_time(returnTm, "%Y-%m-%d %H:%M:%S UTC");
+            out << "\nReturned: " << Utils::Utc{trans.ReturnDate};
         }
-        ss << "\n----------------------------------------\n";
+        out << "\n----------------------------------------\n";
     }
-    return ss.str();
+    AppendNextPage(out, UserCommand::VIEW_ALL_TRANSACTIONS, page, cursor);
 }
 
-std::string LibraryManager::HandleHardDeleteUser(int clientId, const std::string& userId) {
-    auto& session = sessions[clientId];
+void LibraryManager::HandleHardDeleteUser(Session& session, const std::string& userId, ResponseBuffer& out) {
     try {
         int id = std::stoi(userId);
         auto user = users.GetUserById(id);
         
         if (user.UserId == 0) {
             session.state = SessionState::AUTHENTICATED;
-            return "User not found.";
+            out << "User not found.";
+            return;
         }
         
         if (id == session.user.UserId) {
             session.state = SessionState::AUTHENTICATED;
-            return "Cannot delete your own account.";
+            out << "Cannot delete your own account.";
+            return;
         }
         
         session.lastCommand = UserCommand::HARD_DELETE_USER_CONFIRMED;
         session.state = SessionState::WAITING_USER_ID;
-        return "WARNING: This will permanently delete the user account and all history.\n"
+        out << "WARNING: This will permanently delete the user account and all history.\n"
                "This action cannot be undone!\n"
                "Enter user ID again to confirm deletion:";
     } catch (...) {
         session.state = SessionState::AUTHENTICATED;
-        return "Invalid user ID.";
+        out << "Invalid user ID.";
+        return;
     }
 }
 
-std::string LibraryManager::HandleHardDeleteUserConfirmed(int clientId, const std::string& userId) {
-    auto& session = sessions[clientId];
+void LibraryManager::HandleHardDeleteUserConfirmed(Session& session, const std::string& userId, ResponseBuffer& out) {
     try {
         int id = std::stoi(userId);
         if (users.HardDeleteUser(id)) {
             session.state = SessionState::AUTHENTICATED;
-            return "User has been permanently deleted.";
+            out << "User has been permanently deleted.";
+            return;
         }
         session.state = SessionState::AUTHENTICATED;
-        return "Failed to delete user.";
+        out << "Failed to delete user.";
+        return;
     } catch (...) {
         session.state = SessionState::AUTHENTICATED;
-        return "Invalid user ID.";
+        out << "Invalid user ID.";
+        return;
     }
 }
 //add a readme file
 
-std::string LibraryManager::HandleChangePassword(int clientId, const std::string& newPassword) {
-    auto& session = sessions[clientId];
-    
+void LibraryManager::HandleViewAuthMetrics(ResponseBuffer& out) {
+    auto stats = AuthPool::Shared().Stats();
+    out << "Auth pool: " << stats.threads << " thread(s)\n";
+    out << "Queue depth: " << stats.queueDepth << " of " << stats.queueCapacity << "\n";
+    out << "Hashes: " << stats.completed << " completed, " << stats.rejected << " rejected (queue full)\n";
+    out << "Queue wait: " << stats.averageWaitMicros << " us average\n";
+    out << "Hash latency: " << stats.averageHashMicros << " us average, " << stats.maxHashMicros << " us max\n";
+}
+
+void LibraryManager::HandleChangePassword(Session& session, const std::string& newPassword, ResponseBuffer& out) {
     if (!ValidatePassword(newPassword)) {
         session.state = SessionState::AUTHENTICATED;
-        return "Password must be at least 8 characters long, contain at least one uppercase letter, "
+        out << "Password must be at least 8 characters long, contain at least one uppercase letter, "
                "one lowercase letter, one number, and no spaces.";
+        return;
     }
     
-    if (users.UpdatePassword(session.user.UserId, newPassword)) {
-        session.state = SessionState::AUTHENTICATED;
-        return "Password changed successfully.";
-    }
-    
+    std::string result = users.UpdatePassword(session.user.UserId, newPassword);
     session.state = SessionState::AUTHENTICATED;
-    return "Failed to change password.";
+    if (result == "success") {
+        out << "Password changed successfully.";
+    } else if (result == Users::ServerBusy) {
+        out << result;
+    } else {
+        out << "Failed to change password.";
+    }
 }
 
 bool LibraryManager::ValidatePassword(const std::string& password) {
@@ -1,104 +1,430 @@
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <map>
+#include <algorithm>
+#include <cstdio>
+#include <cctype>
 #include <sys/file.h>
+#include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include "../Interfaces/Audits.hpp"
+#include "../Utils/IdSequence.hpp"
+#include "../Utils/JsonRecordReader.hpp"
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
-Audits::Audits()
+namespace {
+    json AuditLogToJson(const AuditLogDto& auditLog) {
+        json auditJson;
+        auditJson["AuditLogId"] = auditLog.AuditLogId;
+        auditJson["Action"] = auditLog.Action;
+        auditJson["ClientIp"] = auditLog.ClientIp;
+        auditJson["DateCreated"] = auditLog.DateCreated;
+        auditJson["Description"] = auditLog.Description;
+        auditJson["MachineName"] = auditLog.MachineName;
+        return auditJson;
+    }
+
+    struct AuditLogDecoder {
+        using Record = AuditLogDto;
+
+        static void Set(AuditLogDto& auditLog, const std::string& field, const std::string&,
+                        const Utils::JsonValue& value) {
+            if (field == "AuditLogId") auditLog.AuditLogId = value.Int();
+            else if (field == "Action") auditLog.Action = value.TakeString();
+            else if (field == "ClientIp") auditLog.ClientIp = value.TakeString();
+            else if (field == "DateCreated") auditLog.DateCreated = value.Time();
+            else if (field == "Description") auditLog.Description = value.TakeString();
+            else if (field == "MachineName") auditLog.MachineName = value.TakeString();
+        }
+        static void BeginElement(AuditLogDto&, const std::string&) {}
+        static void Finish(AuditLogDto&) {}
+    };
+
+    // Parses one line; torn or malformed lines are skipped rather than failing the read.
+    bool ParseLine(const std::string& line, AuditLogDto& auditLog) {
+        if (line.empty()) return false;
+        return Utils::ParseJsonRecord<AuditLogDecoder>(line, auditLog);
+    }
+
+    bool ReadGzLine(gzFile file, std::string& line) {
+        line.clear();
+        char buffer[4096];
+        while (gzgets(file, buffer, sizeof(buffer)) != nullptr) {
+            line += buffer;
+            if (!line.empty() && line.back() == '\n') {
+                line.pop_back();
+                return true;
+            }
+        }
+        return !line.empty();
+    }
+
+    // Feeds every record of one segment, plain or gzipped, to visitor. False
+    // once the visitor asks to stop.
+    bool ForEachInSegment(const std::string& segment, const std::function<bool(const AuditLogDto&)>& visitor) {
+        std::string line;
+        AuditLogDto auditLog;
+        bool compressed = segment.size() > 3 && segment.compare(segment.size() - 3, 3, ".gz") == 0;
+        if (compressed) {
+            gzFile file = gzopen(segment.c_str(), "rb");
+            if (file == nullptr) return true;
+            while (ReadGzLine(file, line)) {
+                if (ParseLine(line, auditLog) && !visitor(auditLog)) {
+                    gzclose(file);
+                    return false;
+                }
+            }
+            gzclose(file);
+        } else {
+            // Compressed since it was listed: read the gzip copy instead.
+            std::ifstream file(segment);
+            if (!file.is_open() && fs::exists(segment + ".gz")) {
+                return ForEachInSegment(segment + ".gz", visitor);
+            }
+            while (std::getline(file, line)) {
+                if (ParseLine(line, auditLog) && !visitor(auditLog)) return false;
+            }
+        }
+        return true;
+    }
+
+    bool StartsWithArray(const std::string& path) {
+        std::ifstream file(path);
+        char c;
+        while (file.get(c)) {
+            if (!std::isspace(static_cast<unsigned char>(c))) return c == '[';
+        }
+        return false;
+    }
+
+    bool WriteAll(int fd, const std::string& text) {
+        size_t written = 0;
+        while (written < text.size()) {
+            ssize_t n = write(fd, text.data() + written, text.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            written += n;
+        }
+        return true;
+    }
+
+    bool CompressFile(const std::string& source, const std::string& target) {
+        std::ifstream in(source, std::ios::binary);
+        if (!in.is_open()) return false;
+
+        std::string tmp = target + ".tmp";
+        gzFile out = gzopen(tmp.c_str(), "wb6");
+        if (out == nullptr) return false;
+
+        char buffer[65536];
+        bool ok = true;
+        while (ok && in) {
+            in.read(buffer, sizeof(buffer));
+            std::streamsize count = in.gcount();
+            if (count > 0 && gzwrite(out, buffer, static_cast<unsigned>(count)) != count) ok = false;
+        }
+        if (gzclose(out) != Z_OK) ok = false;
+        if (!ok || std::rename(tmp.c_str(), target.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+}
+
+Audits::Audits() : appendFd(-1), segmentStarted(0), compressRunning(true)
 {
-    filename = "./resources/database/audits.json";
+    filename = "./resources/database/audits.jsonl";
     fs::create_directories("./resources/database");
-    if (!fs::exists(filename)) {
-        std::ofstream file(filename);
-        file << "[]";
-        file.close();
+
+    // Carry over the trail from the former single-array audits.json, or
+    // convert audits.jsonl in place if it still holds such an array.
+    const std::string legacyFile = "./resources/database/audits.json";
+    if (fs::exists(filename) && StartsWithArray(filename)) {
+        MigrateLegacyArray(filename);
+    } else if (!fs::exists(filename) && fs::exists(legacyFile) && StartsWithArray(legacyFile)) {
+        MigrateLegacyArray(legacyFile);
     }
+    InitIdSequence();
+    OpenActiveSegment();
+    StartCompression();
 }
 
-Audits::Audits(const std::string& fname) : filename(fname) {}
+Audits::Audits(const std::string& fname, const AuditRotationPolicy& policy)
+    : filename(fname), rotation(policy), appendFd(-1), segmentStarted(0), compressRunning(true) {
+    if (fs::exists(filename) && StartsWithArray(filename)) {
+        MigrateLegacyArray(filename);
+    }
+    InitIdSequence();
+    OpenActiveSegment();
+    StartCompression();
+}
 
-Audits::~Audits() {}
+// Segments still queued are compressed before the thread exits.
+Audits::~Audits() {
+    {
+        std::lock_guard<std::mutex> lock(compressMutex);
+        compressRunning = false;
+    }
+    compressSignal.notify_all();
+    if (compressThread.joinable()) {
+        compressThread.join();
+    }
+    if (appendFd >= 0) {
+        close(appendFd);
+    }
+}
 
 bool Audits::AddAuditLog(AuditLogDto auditLog) {
+    return AddAuditLogs({auditLog});
+}
+
+bool Audits::AddAuditLogs(std::vector<AuditLogDto> auditLogs) {
+    if (auditLogs.empty()) return true;
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
-        
-        flock(fd, LOCK_EX);
-        auto logs = LoadFromFile();
-        
-        auditLog.AuditLogId = GetNextAuditLogId();
-        logs.push_back(auditLog);
-        SaveToFile(logs);
-        
-        flock(fd, LOCK_UN);
-        close(fd);
+        std::lock_guard<std::mutex> lock(writeMutex);
+        RotateIfNeeded(std::time(nullptr));
+        if (appendFd < 0) return false;
+
+        std::string text;
+        for (auto& auditLog : auditLogs) {
+            auditLog.AuditLogId = GetNextAuditLogId();
+            text += AuditLogToJson(auditLog).dump();
+            text += '\n';
+        }
+
+        flock(appendFd, LOCK_EX);
+        bool written = WriteAll(appendFd, text) && fdatasync(appendFd) == 0;
+        flock(appendFd, LOCK_UN);
+        if (!written) return false;
+
+        if (segmentStarted == 0) {
+            segmentStarted = auditLogs.front().DateCreated;
+        }
         return true;
     } catch (...) {
         return false;
     }
 }
 
+bool Audits::ForEachAuditLog(const std::function<bool(const AuditLogDto&)>& visitor) const {
+    std::vector<std::string> segments = SealedSegments();
+    segments.push_back(filename);
+
+    for (const auto& segment : segments) {
+        if (!ForEachInSegment(segment, visitor)) return true;
+    }
+    return true;
+}
+
 std::vector<AuditLogDto> Audits::GetAllAuditLogs() {
+    std::vector<AuditLogDto> auditLogs;
     try {
-        return LoadFromFile();
+        ForEachAuditLog([&auditLogs](const AuditLogDto& auditLog) {
+            auditLogs.push_back(auditLog);
+            return true;
+        });
     } catch (...) {
         return std::vector<AuditLogDto>();
     }
+    return auditLogs;
+}
+
+void Audits::InitIdSequence() {
+    idSequence = IdSequence::For(filename);
+
+    // Always checked against the data, so a stale or lost .seq sidecar cannot
+    // hand out ids that are already taken. Ids only grow, so the newest segment
+    // holding any record has the largest.
+    int maxId = 0;
+    try {
+        std::vector<std::string> segments = SealedSegments();
+        segments.push_back(filename);
+        for (auto segment = segments.rbegin(); segment != segments.rend() && maxId == 0; ++segment) {
+            ForEachInSegment(*segment, [&maxId](const AuditLogDto& record) {
+                maxId = std::max(maxId, record.AuditLogId);
+                return true;
+            });
+        }
+    } catch (...) {}
+    idSequence->EnsureAtLeast(maxId + 1);
 }
 
 int Audits::GetNextAuditLogId() const {
-    auto audit = LoadFromFile();
-    if (audit.empty()) return 1;
-    
-    return std::max_element(audit.begin(), audit.end(),
-        [](const AuditLogDto& a, const AuditLogDto& b) { 
-            return a.AuditLogId < b.AuditLogId; 
-        })->AuditLogId + 1;
-}
-
-void Audits::SaveToFile(const std::vector<AuditLogDto>& auditLogs) const {
-    json j = json::array();
-    for (const auto& auditLog : auditLogs) {
-        json auditJson;
-        auditJson["AuditLogId"] = auditLog.AuditLogId;
-        auditJson["Action"] = auditLog.Action;
-        auditJson["ClientIp"] = auditLog.ClientIp;
-        auditJson["DateCreated"] = auditLog.DateCreated;
-        auditJson["Description"] = auditLog.Description;
-        auditJson["MachineName"] = auditLog.MachineName;
-        j.push_back(auditJson);
+    return idSequence->Next();
+}
+
+// Rewrites a JSON-array audit file as JSON Lines into filename. A separate
+// source is kept alongside as source.migrated.
+void Audits::MigrateLegacyArray(const std::string& source) {
+    std::string text;
+    size_t migrated = 0;
+    {
+        std::ifstream file(source);
+        Utils::ForEachJsonRecord<AuditLogDecoder>(file, [&text, &migrated](AuditLogDto& auditLog) {
+            text += AuditLogToJson(auditLog).dump();
+            text += '\n';
+            migrated++;
+            return true;
+        });
+    }
+
+    std::string tmp = filename + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        throw std::runtime_error("Error: Failed to migrate audit logs");
     }
-    
-    std::ofstream file(filename);
-    file << std::setw(4) << j << std::endl;
+    bool written = WriteAll(fd, text) && fsync(fd) == 0;
+    close(fd);
+    if (!written || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Error: Failed to migrate audit logs");
+    }
+    if (source != filename) {
+        std::rename(source.c_str(), (source + ".migrated").c_str());
+    }
+    std::cout << "Migrated " << migrated << " audit log(s) to " << filename << std::endl;
 }
 
-std::vector<AuditLogDto> Audits::LoadFromFile() const {
-    std::vector<AuditLogDto> auditLogs;
+void Audits::OpenActiveSegment() {
+    appendFd = open(filename.c_str(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (appendFd == -1) {
+        throw std::runtime_error("Error: Failed to open audit log " + filename);
+    }
+    segmentStarted = 0;
+
+    struct stat st;
+    if (fstat(appendFd, &st) != 0 || st.st_size == 0) return;
+
+    // Terminate a line torn by a crash so the next record starts cleanly.
+    char last;
+    if (pread(appendFd, &last, 1, st.st_size - 1) == 1 && last != '\n') {
+        WriteAll(appendFd, "\n");
+    }
+
     std::ifstream file(filename);
-    if (!file.is_open()) return auditLogs;
-    
-    json j;
-    file >> j;
-    
-    for (const auto& auditJson : j) {
-        AuditLogDto auditLog;
-        auditLog.AuditLogId = auditJson["AuditLogId"];
-        auditLog.Action = auditJson["Action"];
-        auditLog.ClientIp = auditJson["ClientIp"];
-        auditLog.DateCreated = auditJson["DateCreated"];
-        auditLog.Description = auditJson["Description"];
-        auditLog.MachineName = auditJson["MachineName"];
-    
-        auditLogs.push_back(auditLog);
-    }
-    
-    return auditLogs;
-}
\ No newline at end of file
+    std::string line;
+    AuditLogDto first;
+    if (std::getline(file, line) && ParseLine(line, first)) {
+        segmentStarted = first.DateCreated;
+    }
+}
+
+void Audits::RotateIfNeeded(std::time_t now) {
+    struct stat st;
+    if (appendFd < 0 || fstat(appendFd, &st) != 0 || st.st_size == 0) return;
+
+    bool tooLarge = rotation.maxSegmentBytes > 0 &&
+                    static_cast<size_t>(st.st_size) >= rotation.maxSegmentBytes;
+    bool tooOld = rotation.maxSegmentAgeSeconds > 0 && segmentStarted > 0 &&
+                  now - segmentStarted >= rotation.maxSegmentAgeSeconds;
+    if (!tooLarge && !tooOld) return;
+
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%06d", LastSegmentNumber() + 1);
+    std::string sealed = filename + suffix;
+
+    flock(appendFd, LOCK_EX);
+    bool renamed = std::rename(filename.c_str(), sealed.c_str()) == 0;
+    flock(appendFd, LOCK_UN);
+    if (!renamed) {
+        std::cerr << "Failed to rotate audit log " << filename << std::endl;
+        return;
+    }
+    close(appendFd);
+    appendFd = -1;
+    OpenActiveSegment();
+
+    if (rotation.compressRotated) {
+        QueueCompression(sealed);
+    }
+}
+
+// Also picks up segments left uncompressed by a crash or an earlier run.
+void Audits::StartCompression() {
+    if (!rotation.compressRotated) return;
+    for (const auto& segment : SealedSegments()) {
+        if (fs::path(segment).extension() != ".gz") {
+            pendingCompression.push_back(segment);
+        }
+    }
+    compressThread = std::thread(&Audits::CompressLoop, this);
+}
+
+void Audits::QueueCompression(const std::string& sealed) {
+    {
+        std::lock_guard<std::mutex> lock(compressMutex);
+        pendingCompression.push_back(sealed);
+    }
+    compressSignal.notify_all();
+}
+
+void Audits::CompressLoop() {
+    std::unique_lock<std::mutex> lock(compressMutex);
+    while (true) {
+        compressSignal.wait(lock, [this] { return !pendingCompression.empty() || !compressRunning; });
+        if (pendingCompression.empty()) return;
+
+        std::string sealed = pendingCompression.front();
+        lock.unlock();
+        if (CompressFile(sealed, sealed + ".gz")) {
+            std::remove(sealed.c_str());
+        } else {
+            std::cerr << "Failed to compress audit segment " << sealed << std::endl;
+        }
+        lock.lock();
+        pendingCompression.pop_front();
+        compressSignal.notify_all();
+    }
+}
+
+void Audits::WaitForCompression() {
+    std::unique_lock<std::mutex> lock(compressMutex);
+    compressSignal.wait(lock, [this] { return pendingCompression.empty(); });
+}
+
+// Sealed segments in rotation order. A segment caught mid-compression is read
+// from its gzip copy once that exists.
+std::vector<std::string> Audits::SealedSegments() const {
+    std::map<int, std::string> segments;
+    fs::path active(filename);
+    fs::path dir = active.has_parent_path() ? active.parent_path() : fs::path(".");
+    std::string prefix = active.filename().string() + ".";
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() < prefix.size() + 6 || name.compare(0, prefix.size(), prefix) != 0) continue;
+
+        std::string rest = name.substr(prefix.size());
+        bool compressed = rest.size() == 9 && rest.compare(6, 3, ".gz") == 0;
+        if (rest.size() != 6 && !compressed) continue;
+        if (!std::all_of(rest.begin(), rest.begin() + 6, [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) continue;
+
+        int number = std::stoi(rest.substr(0, 6));
+        if (compressed || segments.count(number) == 0) {
+            segments[number] = entry.path().string();
+        }
+    }
+
+    std::vector<std::string> ordered;
+    for (const auto& segment : segments) {
+        ordered.push_back(segment.second);
+    }
+    return ordered;
+}
+
+int Audits::LastSegmentNumber() const {
+    auto segments = SealedSegments();
+    if (segments.empty()) return 0;
+    std::string name = fs::path(segments.back()).filename().string();
+    std::string prefix = fs::path(filename).filename().string() + ".";
+    return std::stoi(name.substr(prefix.size(), 6));
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
+
+#include "../Interfaces/BookIndex.hpp"
+#include "../Utils/NGramUtils.hpp"
+
+namespace {
+    void AddGrams(std::unordered_set<std::string>& grams, const std::string& text, size_t n) {
+        for (size_t i = 0; i + n <= text.size(); i++) {
+            grams.insert(text.substr(i, n));
+        }
+    }
+
+    void AddTokens(std::unordered_set<std::string>& tokens, const std::string& text) {
+        std::stringstream ss(text);
+        std::string token;
+        while (ss >> token) {
+            tokens.insert(token);
+        }
+    }
+}
+
+BookIndex::BookIndex() : bigramPostings(1 << 16), staleEntries(0) {}
+
+void BookIndex::Add(const IndexedBook& book) {
+    if (entries.count(book.BookId) > 0) {
+        Remove(book.BookId);
+    }
+    entries[book.BookId] = book;
+    AddPostings(book);
+}
+
+void BookIndex::Remove(int bookId) {
+    if (entries.erase(bookId) == 0) return;
+
+    // Postings still reference the id; they are skipped at query time and
+    // dropped wholesale once they outweigh the live entries.
+    staleEntries++;
+    if (staleEntries > 64 && staleEntries > entries.size()) {
+        Rebuild();
+    }
+}
+
+void BookIndex::Clear() {
+    entries.clear();
+    tokenPostings.clear();
+    for (auto& postings : bigramPostings) postings.clear();
+    isbnGramPostings.clear();
+    soundexBuckets.clear();
+    staleEntries = 0;
+}
+
+const IndexedBook* BookIndex::Find(int bookId) const {
+    auto it = entries.find(bookId);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+size_t BookIndex::Size() const {
+    return entries.size();
+}
+
+void BookIndex::AddPostings(const IndexedBook& book) {
+    std::unordered_set<std::string> tokens;
+    AddTokens(tokens, book.Name);
+    AddTokens(tokens, book.Author);
+    AddTokens(tokens, book.Publisher);
+    for (const auto& token : tokens) {
+        tokenPostings[token].push_back(book.BookId);
+    }
+
+    std::vector<uint16_t> bigrams;
+    bigrams.insert(bigrams.end(), book.NameBigrams.begin(), book.NameBigrams.end());
+    bigrams.insert(bigrams.end(), book.AuthorBigrams.begin(), book.AuthorBigrams.end());
+    bigrams.insert(bigrams.end(), book.PublisherBigrams.begin(), book.PublisherBigrams.end());
+    std::sort(bigrams.begin(), bigrams.end());
+    bigrams.erase(std::unique(bigrams.begin(), bigrams.end()), bigrams.end());
+    for (uint16_t code : bigrams) {
+        bigramPostings[code].push_back(book.BookId);
+    }
+
+    std::unordered_set<std::string> isbnGrams;
+    AddGrams(isbnGrams, book.Isbn, 2);
+    AddGrams(isbnGrams, book.Isbn, 3);
+    for (const auto& gram : isbnGrams) {
+        isbnGramPostings[gram].push_back(book.BookId);
+    }
+
+    if (!book.NameSoundex.empty()) {
+        soundexBuckets[book.NameSoundex].push_back(book.BookId);
+    }
+    if (!book.AuthorSoundex.empty() && book.AuthorSoundex != book.NameSoundex) {
+        soundexBuckets[book.AuthorSoundex].push_back(book.BookId);
+    }
+}
+
+void BookIndex::Rebuild() {
+    tokenPostings.clear();
+    for (auto& postings : bigramPostings) postings.clear();
+    isbnGramPostings.clear();
+    soundexBuckets.clear();
+    staleEntries = 0;
+    for (const auto& entry : entries) {
+        AddPostings(entry.second);
+    }
+}
+
+std::vector<int> BookIndex::FindCandidates(const std::vector<std::string>& tokens,
+                                           const std::vector<std::string>& tokenSoundex) const {
+    std::vector<int> candidates;
+    auto collect = [&candidates](const Postings& postings, const std::string& key) {
+        auto it = postings.find(key);
+        if (it != postings.end()) {
+            candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+    };
+
+    for (size_t t = 0; t < tokens.size(); t++) {
+        const std::string& token = tokens[t];
+
+        // Any substring or fuzzy hit on name/author/publisher shares a bigram.
+        collect(tokenPostings, token);
+        for (size_t i = 0; i + 2 <= token.size(); i++) {
+            const auto& postings = bigramPostings[Utils::PackBigram(token[i], token[i + 1])];
+            candidates.insert(candidates.end(), postings.begin(), postings.end());
+        }
+
+        // An ISBN substring hit must contain every trigram of the token, so the
+        // rarest one bounds the candidates.
+        if (token.size() >= 3) {
+            const std::vector<int>* rarest = nullptr;
+            for (size_t i = 0; i + 3 <= token.size(); i++) {
+                auto it = isbnGramPostings.find(token.substr(i, 3));
+                if (it == isbnGramPostings.end()) {
+                    rarest = nullptr;
+                    break;
+                }
+                if (rarest == nullptr || it->second.size() < rarest->size()) {
+                    rarest = &it->second;
+                }
+            }
+            if (rarest != nullptr) {
+                candidates.insert(candidates.end(), rarest->begin(), rarest->end());
+            }
+        } else {
+            collect(isbnGramPostings, token);
+        }
+
+        if (t < tokenSoundex.size()) {
+            collect(soundexBuckets, tokenSoundex[t]);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (staleEntries > 0) {
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+            [this](int id) { return entries.find(id) == entries.end(); }), candidates.end());
+    }
+    return candidates;
+}
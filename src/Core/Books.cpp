@@ -1,14 +1,61 @@
 #include <nlohmann/json.hpp>
 #include <filesystem>
-#include <sys/file.h>
-#include <fcntl.h>
-#include <unistd.h>
 
 #include "../Interfaces/Books.hpp"
+#include "../Interfaces/LibraryJournal.hpp"
+#include "../Utils/IdSequence.hpp"
+#include "../Utils/StoreFile.hpp"
+#include "../Utils/NGramUtils.hpp"
+#include "../Utils/JsonRecordReader.hpp"
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
+namespace {
+    struct BookDecoder {
+        using Record = BooksDto;
+
+        static void Set(BooksDto& book, const std::string& field, const std::string& member,
+                        const Utils::JsonValue& value) {
+            // Older files embed whole category objects; only their ids are kept.
+            if (field == "Categories") {
+                if (member == "CategoryId") book.CategoryIds.push_back(value.Int());
+                return;
+            }
+            if (field == "CategoryIds") {
+                book.CategoryIds.push_back(value.Int());
+                return;
+            }
+            if (field == "BookId") book.BookId = value.Int();
+            else if (field == "Name") book.Name = value.TakeString();
+            else if (field == "Isbn") book.Isbn = value.TakeString();
+            else if (field == "Author") book.Author = value.TakeString();
+            else if (field == "Publisher") book.Publisher = value.TakeString();
+            else if (field == "NoOfCopies") book.NoOfCopies = value.Int();
+            else if (field == "DateCreated") book.DateCreated = value.Time();
+            else if (field == "DateUpdated") book.DateUpdated = value.Time();
+            else if (field == "Status") book.Status = static_cast<BookStatus>(value.Int());
+        }
+        static void BeginElement(BooksDto&, const std::string&) {}
+        static void Finish(BooksDto&) {}
+    };
+
+    json BookToJson(const BooksDto& book) {
+        json bookJson;
+        bookJson["BookId"] = book.BookId;
+        bookJson["Name"] = book.Name;
+        bookJson["Isbn"] = book.Isbn;
+        bookJson["Author"] = book.Author;
+        bookJson["Publisher"] = book.Publisher;
+        bookJson["NoOfCopies"] = book.NoOfCopies;
+        bookJson["DateCreated"] = book.DateCreated;
+        bookJson["DateUpdated"] = book.DateUpdated;
+        bookJson["Status"] = static_cast<int>(book.Status);
+        bookJson["CategoryIds"] = book.CategoryIds;
+        return bookJson;
+    }
+}
+
 Books::Books()
 {
     filename = "./resources/database/books.json";
@@ -18,40 +65,57 @@ Books::Books()
         file << "[]";
         file.close();
     }
+    LoadCatalog();
 }
 
-Books::Books(const std::string& fname) : filename(fname) {}
+Books::Books(const std::string& fname) : filename(fname) {
+    LoadCatalog();
+}
 
 Books::~Books() {}
 
+void Books::LoadCatalog() {
+    std::unique_lock<std::shared_mutex> lock(catalogMutex);
+    storeFile = StoreFile::For(filename);
+    catalog.clear();
+    searchIndex.Clear();
+    booksByCategory.clear();
+    try {
+        for (auto& book : LoadFromFile()) {
+            int id = book.BookId;
+            searchIndex.Add(MakeIndexEntry(book));
+            IndexCategoriesLocked(book);
+            catalog[id] = std::move(book);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load book catalog: " << e.what() << std::endl;
+    }
+    idSequence = IdSequence::For(filename);
+    idSequence->EnsureAtLeast(catalog.empty() ? 1 : catalog.rbegin()->first + 1);
+}
+
 int Books::GetNextBookId() const {
-    auto books = LoadFromFile();
-    if (books.empty()) return 1;
-    
-    return std::max_element(books.begin(), books.end(),
-        [](const BooksDto& a, const BooksDto& b) { 
-            return a.BookId < b.BookId; 
-        })->BookId + 1;
+    return idSequence->Next();
 }
 
 bool Books::AddBook(BooksDto book) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
-        
-        // Lock file for writing
-        flock(fd, LOCK_EX);
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
         
-        auto books = LoadFromFile();
         book.BookId = GetNextBookId();
         book.DateCreated = std::time(nullptr);
         book.DateUpdated = std::time(nullptr);
-        books.push_back(book);
-        SaveToFile(books);
+        catalog[book.BookId] = book;
+        try {
+            PersistLocked(book.BookId);
+        } catch (...) {
+            catalog.erase(book.BookId);
+            return false;
+        }
+        searchIndex.Add(MakeIndexEntry(book));
+        IndexCategoriesLocked(book);
         
-        // Unlock and close
-        flock(fd, LOCK_UN);
-        close(fd);
         return true;
     } catch (...) {
         return false;
@@ -59,130 +123,222 @@ bool Books::AddBook(BooksDto book) {
 }
 
 std::vector<BooksDto> Books::GetAllBooks() {
-    int fd = open(filename.c_str(), O_RDONLY);
-    if (fd == -1) return {};
-    
-    // Shared lock for reading
-    flock(fd, LOCK_SH);
-    auto books = LoadFromFile();
-    flock(fd, LOCK_UN);
-    close(fd);
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    std::vector<BooksDto> books;
+    books.reserve(catalog.size());
+    for (const auto& entry : catalog) {
+        books.push_back(CopyRowLocked(entry.second));
+    }
     return books;
 }
 
 BooksDto Books::GetBooksById(int id) {
-    auto books = GetAllBooks();
-    auto it = std::find_if(books.begin(), books.end(),
-        [id](const BooksDto& book) { return book.BookId == id; });
-    return it != books.end() ? *it : BooksDto{};
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    auto it = catalog.find(id);
+    return it != catalog.end() ? CopyRowLocked(it->second) : BooksDto{};
 }
 
-bool Books::RemoveBook(int bookId) {
+std::unordered_map<int, BooksDto> Books::GetBooksByIds(const std::vector<int>& ids) {
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    std::unordered_map<int, BooksDto> books;
+    books.reserve(ids.size());
+    for (int id : ids) {
+        if (books.count(id)) continue;
+        auto it = catalog.find(id);
+        if (it != catalog.end()) {
+            books.emplace(id, CopyRowLocked(it->second));
+        }
+    }
+    return books;
+}
+
+std::vector<BooksDto> Books::GetBooksByCategory(int categoryId) {
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
+    std::vector<BooksDto> books;
+    auto entry = booksByCategory.find(categoryId);
+    if (entry == booksByCategory.end()) return books;
+    books.reserve(entry->second.size());
+    for (int bookId : entry->second) {
+        books.push_back(CopyRowLocked(catalog.at(bookId)));
+    }
+    return books;
+}
+
+bool Books::DetachCategory(int categoryId) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
         
-        flock(fd, LOCK_EX);
-        auto books = LoadFromFile();
+        auto entry = booksByCategory.find(categoryId);
+        if (entry == booksByCategory.end()) return true;
         
-        auto it = std::remove_if(books.begin(), books.end(),
-            [bookId](const BooksDto& book) { return book.BookId == bookId; });
+        std::vector<int> bookIds = entry->second;
+        std::vector<BooksDto> previous;
+        previous.reserve(bookIds.size());
+        for (int bookId : bookIds) {
+            BooksDto& book = catalog.at(bookId);
+            previous.push_back(book);
+            book.CategoryIds.erase(std::remove(book.CategoryIds.begin(), book.CategoryIds.end(), categoryId),
+                                   book.CategoryIds.end());
+            book.DateUpdated = std::time(nullptr);
+        }
+        try {
+            PersistLocked(bookIds);
+        } catch (...) {
+            for (auto& book : previous) {
+                catalog[book.BookId] = std::move(book);
+            }
+            return false;
+        }
+        booksByCategory.erase(categoryId);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+bool Books::RemoveBook(int bookId) {
+    try {
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
         
-        if (it != books.end()) {
-            books.erase(it, books.end());
-            SaveToFile(books);
+        auto it = catalog.find(bookId);
+        if (it != catalog.end()) {
+            BooksDto removed = std::move(it->second);
+            catalog.erase(it);
+            try {
+                PersistLocked(bookId);
+            } catch (...) {
+                catalog[bookId] = std::move(removed);
+                return false;
+            }
+            searchIndex.Remove(bookId);
+            UnindexCategoriesLocked(removed);
         }
         
-        flock(fd, LOCK_UN);
-        close(fd);
         return true;
     } catch (...) {
         return false;
     }
 }
 
-void Books::SaveToFile(const std::vector<BooksDto>& books) const {
+// Caller must hold catalogMutex and a StoreFile::Lock.
+void Books::SaveToFile() const {
     json j = json::array();
-    for (const auto& book : books) {
-        json bookJson;
-        bookJson["BookId"] = book.BookId;
-        bookJson["Name"] = book.Name;
-        bookJson["Isbn"] = book.Isbn;
-        bookJson["Author"] = book.Author;
-        bookJson["Publisher"] = book.Publisher;
-        bookJson["NoOfCopies"] = book.NoOfCopies;
-        bookJson["DateCreated"] = book.DateCreated;
-        bookJson["DateUpdated"] = book.DateUpdated;
-        bookJson["Status"] = static_cast<int>(book.Status);
-        bookJson["Categories"] = json::array();
-        for (const auto& category : book.Categories) {
-            json categoryJson;
-            categoryJson["CategoryId"] = category.CategoryId;
-            categoryJson["Name"] = category.Name;
-            categoryJson["Description"] = category.Description;
-            categoryJson["DateCreated"] = category.DateCreated;
-            bookJson["Categories"].push_back(categoryJson);
-        }
-        j.push_back(bookJson);
+    for (const auto& entry : catalog) {
+        j.push_back(BookToJson(entry.second));
     }
     
-    std::ofstream file(filename);
-    file << std::setw(4) << j << std::endl;
+    storeFile->Replace(j.dump(4) + "\n");
 }
 
-std::vector<BooksDto> Books::LoadFromFile() const {
-    std::vector<BooksDto> books;
-    std::ifstream file(filename);
-    if (!file.is_open()) return books;
-    
-    json j;
-    file >> j;
-    
-    for (const auto& bookJson : j) {
-        BooksDto book;
-        book.BookId = bookJson["BookId"];
-        book.Name = bookJson["Name"];
-        book.Isbn = bookJson["Isbn"];
-        book.Author = bookJson["Author"];
-        book.Publisher = bookJson["Publisher"];
-        book.NoOfCopies = bookJson["NoOfCopies"];
-        book.DateCreated = bookJson["DateCreated"];
-        book.DateUpdated = bookJson["DateUpdated"];
-        book.Status = static_cast<BookStatus>(bookJson["Status"]);
-        
-        for (const auto& categoryJson : bookJson["Categories"]) {
-            CategoryDto category;
-            category.CategoryId = categoryJson["CategoryId"];
-            category.Name = categoryJson["Name"];
-            category.Description = categoryJson["Description"]; 
-            category.DateCreated = categoryJson["DateCreated"];
-            book.Categories.push_back(category);
+// Caller must hold catalogMutex exclusively with the change already applied to
+// catalog. Throws if the change could not be made durable.
+void Books::PersistLocked(int bookId) {
+    PersistLocked(std::vector<int>{bookId});
+}
+
+void Books::PersistLocked(const std::vector<int>& bookIds) {
+    if (journal == nullptr) {
+        SaveToFile();
+        return;
+    }
+    JournalRecord record;
+    for (int bookId : bookIds) {
+        auto it = catalog.find(bookId);
+        if (it != catalog.end()) {
+            record.books.push_back(EncodeRow(it->second));
+        } else {
+            record.removedBooks.push_back(bookId);
         }
-        books.push_back(book);
     }
-    
-    return books;
+    if (!journal->Append(record)) {
+        throw std::runtime_error("Failed to write journal");
+    }
+}
+
+// Caller must hold catalogMutex exclusively.
+void Books::InstallLocked(const BooksDto& book) {
+    auto it = catalog.find(book.BookId);
+    bool searchable = it == catalog.end() || it->second.Name != book.Name || it->second.Author != book.Author ||
+                      it->second.Publisher != book.Publisher || it->second.Isbn != book.Isbn;
+    if (it == catalog.end() || it->second.CategoryIds != book.CategoryIds) {
+        if (it != catalog.end()) UnindexCategoriesLocked(it->second);
+        IndexCategoriesLocked(book);
+    }
+    catalog[book.BookId] = book;
+    if (searchable) {
+        searchIndex.Add(MakeIndexEntry(book));
+    }
+    idSequence->EnsureAtLeast(book.BookId + 1);
+}
+
+// Caller must hold catalogMutex exclusively.
+void Books::EraseRowLocked(int bookId) {
+    auto it = catalog.find(bookId);
+    if (it == catalog.end()) return;
+    UnindexCategoriesLocked(it->second);
+    catalog.erase(it);
+    searchIndex.Remove(bookId);
+}
+
+// Caller must hold catalogMutex exclusively.
+void Books::IndexCategoriesLocked(const BooksDto& book) {
+    for (int categoryId : book.CategoryIds) {
+        auto& bookIds = booksByCategory[categoryId];
+        auto position = std::lower_bound(bookIds.begin(), bookIds.end(), book.BookId);
+        if (position == bookIds.end() || *position != book.BookId) {
+            bookIds.insert(position, book.BookId);
+        }
+    }
+}
+
+// Caller must hold catalogMutex exclusively.
+void Books::UnindexCategoriesLocked(const BooksDto& book) {
+    for (int categoryId : book.CategoryIds) {
+        auto entry = booksByCategory.find(categoryId);
+        if (entry == booksByCategory.end()) continue;
+        auto& bookIds = entry->second;
+        auto position = std::lower_bound(bookIds.begin(), bookIds.end(), book.BookId);
+        if (position != bookIds.end() && *position == book.BookId) {
+            bookIds.erase(position);
+        }
+        if (bookIds.empty()) {
+            booksByCategory.erase(entry);
+        }
+    }
+}
+
+std::string Books::EncodeRow(const BooksDto& book) {
+    return BookToJson(book).dump();
+}
+
+bool Books::DecodeRow(const std::string& row, BooksDto& book) {
+    return Utils::ParseJsonRecord<BookDecoder>(row, book);
+}
+
+std::vector<BooksDto> Books::LoadFromFile() const {
+    return Utils::ParseJsonRecords<BookDecoder>(storeFile->Read());
 }
 
 bool Books::AddBookCopies(int bookId, int copies) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
-        
-        flock(fd, LOCK_EX);
-        auto books = LoadFromFile();
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
         
-        auto it = std::find_if(books.begin(), books.end(),
-            [bookId](const BooksDto& book) { return book.BookId == bookId; });
-            
-        if (it != books.end()) {
-            it->NoOfCopies += copies;
-            it->DateUpdated = std::time(nullptr);
-            SaveToFile(books);
+        auto it = catalog.find(bookId);
+        if (it != catalog.end()) {
+            BooksDto previous = it->second;
+            it->second.NoOfCopies += copies;
+            it->second.DateUpdated = std::time(nullptr);
+            try {
+                PersistLocked(bookId);
+            } catch (...) {
+                it->second = std::move(previous);
+                return false;
+            }
         }
         
-        flock(fd, LOCK_UN);
-        close(fd);
         return true;
     } catch (...) {
         return false;
@@ -193,6 +349,78 @@ bool Books::RemoveBookCopies(int bookId, int copies) {
     return AddBookCopies(bookId, -copies);
 }
 
+bool Books::TryReserveCopy(int bookId) {
+    return AdjustCopies(bookId, -1);
+}
+
+bool Books::ReleaseCopy(int bookId) {
+    return AdjustCopies(bookId, 1);
+}
+
+// Changes one row's copy count, never below zero. With a journal attached only
+// that row's stripe is held exclusively, so borrows of different titles do not
+// wait on each other; otherwise the whole file is rewritten as before.
+bool Books::AdjustCopies(int bookId, int delta) {
+    try {
+        {
+            std::shared_lock<std::shared_mutex> lock(catalogMutex);
+            auto it = catalog.find(bookId);
+            if (it == catalog.end()) return false;
+            if (journal != nullptr) {
+                std::lock_guard<std::mutex> rowLock(rowLocks[RowStripe(bookId)]);
+                BooksDto updated = it->second;
+                if (updated.NoOfCopies + delta < 0) return false;
+                updated.NoOfCopies += delta;
+                updated.DateUpdated = std::time(nullptr);
+
+                JournalRecord record;
+                record.books.push_back(EncodeRow(updated));
+                if (!journal->Append(record)) return false;
+                ApplyCopiesLocked(updated);
+                return true;
+            }
+        }
+
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(catalogMutex);
+        
+        bool adjusted = false;
+        auto it = catalog.find(bookId);
+        if (it != catalog.end() && it->second.NoOfCopies + delta >= 0) {
+            BooksDto previous = it->second;
+            it->second.NoOfCopies += delta;
+            it->second.DateUpdated = std::time(nullptr);
+            try {
+                PersistLocked(bookId);
+                adjusted = true;
+            } catch (...) {
+                it->second = std::move(previous);
+            }
+        }
+        
+        return adjusted;
+    } catch (...) {
+        return false;
+    }
+}
+
+size_t Books::RowStripe(int bookId) const {
+    return static_cast<size_t>(bookId) % RowLockStripes;
+}
+
+// Caller must hold catalogMutex; the row's stripe keeps the copy count stable.
+BooksDto Books::CopyRowLocked(const BooksDto& book) const {
+    std::lock_guard<std::mutex> rowLock(rowLocks[RowStripe(book.BookId)]);
+    return book;
+}
+
+// Caller must hold catalogMutex (shared is enough) and the row's stripe.
+void Books::ApplyCopiesLocked(const BooksDto& book) {
+    BooksDto& row = catalog.at(book.BookId);
+    row.NoOfCopies = book.NoOfCopies;
+    row.DateUpdated = book.DateUpdated;
+}
+
 std::string Books::GetSoundex(const std::string& word) const {
     if (word.empty()) return "";
     
@@ -204,7 +432,9 @@ std::string Books::GetSoundex(const std::string& word) const {
     char last = '0';
     
     for (size_t i = 1; i < word.length() && j < 4; i++) {
-        char current = mapping[std::tolower(word[i]) - 'a'];
+        unsigned char c = static_cast<unsigned char>(word[i]);
+        if (!std::isalpha(c)) continue;
+        char current = mapping[std::tolower(c) - 'a'];
         if (current != '0' && current != last) {
             result[j++] = current;
             last = current;
@@ -214,25 +444,6 @@ std::string Books::GetSoundex(const std::string& word) const {
     return result;
 }
 
-double Books::CalculateNGramSimilarity(const std::string& s1, const std::string& s2, int n) const {
-    if (s1.empty() || s2.empty()) return 0.0;
-    
-    std::set<std::string> ngrams1, ngrams2;
-    
-    for (size_t i = 0; i <= s1.length() - n; i++)
-        ngrams1.insert(s1.substr(i, n));
-    for (size_t i = 0; i <= s2.length() - n; i++)
-        ngrams2.insert(s2.substr(i, n));
-    
-    int common = 0;
-    for (const auto& ngram : ngrams1) {
-        if (ngrams2.find(ngram) != ngrams2.end())
-            common++;
-    }
-    
-    return (2.0 * common) / (ngrams1.size() + ngrams2.size());
-}
-
 std::vector<std::string> Books::Tokenize(const std::string& text) const {
     std::vector<std::string> tokens;
     std::stringstream ss(text);
@@ -244,62 +455,97 @@ std::vector<std::string> Books::Tokenize(const std::string& text) const {
     return tokens;
 }
 
-double Books::CalculateSearchScore(const BooksDto& book, const std::string& query) const {
-    auto queryTokens = Tokenize(query);
-    double score = 0.0;
+IndexedBook Books::MakeIndexEntry(const BooksDto& book) const {
+    IndexedBook entry;
+    entry.BookId = book.BookId;
+    entry.Name = book.Name;
+    entry.Author = book.Author;
+    entry.Publisher = book.Publisher;
+    entry.Isbn = book.Isbn;
+    std::transform(entry.Name.begin(), entry.Name.end(), entry.Name.begin(), ::tolower);
+    std::transform(entry.Author.begin(), entry.Author.end(), entry.Author.begin(), ::tolower);
+    std::transform(entry.Publisher.begin(), entry.Publisher.end(), entry.Publisher.begin(), ::tolower);
+    entry.NameSoundex = GetSoundex(entry.Name);
+    entry.AuthorSoundex = GetSoundex(entry.Author);
+    entry.NameBigrams = Utils::BigramSignature(entry.Name);
+    entry.AuthorBigrams = Utils::BigramSignature(entry.Author);
+    entry.PublisherBigrams = Utils::BigramSignature(entry.Publisher);
+    return entry;
+}
 
-    std::string bookName = book.Name;
-    std::string bookAuthor = book.Author;
-    std::string bookPublisher = book.Publisher;
-    std::transform(bookName.begin(), bookName.end(), bookName.begin(), ::tolower);
-    std::transform(bookAuthor.begin(), bookAuthor.end(), bookAuthor.begin(), ::tolower);
-    std::transform(bookPublisher.begin(), bookPublisher.end(), bookPublisher.begin(), ::tolower);
+double Books::CalculateSearchScore(const IndexedBook& book, const SearchQuery& query) const {
+    double score = 0.0;
     
-    for (const auto& queryToken : queryTokens) {
+    for (size_t i = 0; i < query.Tokens.size(); i++) {
+        const std::string& queryToken = query.Tokens[i];
+        const auto& queryBigrams = query.Bigrams[i];
+
         // Exact match bonuses
-        if (bookName.find(queryToken) != std::string::npos) score += 1.0;
-        if (bookAuthor.find(queryToken) != std::string::npos) score += 0.8;
+        if (book.Name.find(queryToken) != std::string::npos) score += 1.0;
+        if (book.Author.find(queryToken) != std::string::npos) score += 0.8;
         if (book.Isbn.find(queryToken) != std::string::npos) score += 1.0;
-        if (bookPublisher.find(queryToken) != std::string::npos) score += 0.5;
+        if (book.Publisher.find(queryToken) != std::string::npos) score += 0.5;
         
         // Fuzzy matches
-        double titleScore = CalculateNGramSimilarity(queryToken, bookName, 2) * 0.6;
-        double authorScore = CalculateNGramSimilarity(queryToken, bookAuthor, 2) * 0.4;
-        double publisherScore = CalculateNGramSimilarity(queryToken, bookPublisher, 2) * 0.2;
+        double titleScore = Utils::BigramSimilarity(queryBigrams, book.NameBigrams) * 0.6;
+        double authorScore = Utils::BigramSimilarity(queryBigrams, book.AuthorBigrams) * 0.4;
+        double publisherScore = Utils::BigramSimilarity(queryBigrams, book.PublisherBigrams) * 0.2;
         
         // Phonetic matching
-        if (GetSoundex(queryToken) == GetSoundex(bookName) ||
-            GetSoundex(queryToken) == GetSoundex(bookAuthor))
+        if (query.Soundex[i] == book.NameSoundex || query.Soundex[i] == book.AuthorSoundex)
             score += 0.3;
             
         score += titleScore + authorScore + publisherScore;
     }
     
-    return score / queryTokens.size();
+    return score / query.Tokens.size();
 }
 
-std::vector<Books::SearchResult> Books::SearchBooks(const std::string& query, size_t limit) const {
+std::vector<Books::SearchResult> Books::SearchBooks(const std::string& query, size_t limit,
+                                                   const SearchPosition* after) const {
     std::vector<SearchResult> results;
-    auto books = LoadFromFile();
+
+    // Tokens shorter than a bigram carry no fuzzy signal and would match
+    // nearly every title, so they are not searched on.
+    SearchQuery prepared;
+    prepared.Tokens = Tokenize(query);
+    prepared.Tokens.erase(std::remove_if(prepared.Tokens.begin(), prepared.Tokens.end(),
+        [](const std::string& token) { return token.size() < 2; }), prepared.Tokens.end());
+    if (prepared.Tokens.empty() || limit == 0) return results;
+
+    for (const auto& token : prepared.Tokens) {
+        prepared.Soundex.push_back(GetSoundex(token));
+        prepared.Bigrams.push_back(Utils::BigramSignature(token));
+    }
+
+    std::shared_lock<std::shared_mutex> lock(catalogMutex);
     
     std::cout << "Searching for: " << query << std::endl;
-    std::cout << "Number of books in database: " << books.size() << std::endl;
+    auto candidates = searchIndex.FindCandidates(prepared.Tokens, prepared.Soundex);
+    std::cout << "Scoring " << candidates.size() << " of " << catalog.size() << " books" << std::endl;
     
-    for (const auto& book : books) {
-        double score = CalculateSearchScore(book, query);
-        std::cout << "Score for book '" << book.Name << "': " << score << std::endl;
-        
-        if (score > 0.1) {
-            results.push_back({book, score});
+    // Highest score first, ties in catalog order.
+    auto byRelevance = [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+
+    std::vector<std::pair<double, int>> scored;
+    for (int bookId : candidates) {
+        const IndexedBook* entry = searchIndex.Find(bookId);
+        if (entry == nullptr) continue;
+        double score = CalculateSearchScore(*entry, prepared);
+        if (score > 0.1 && (after == nullptr || byRelevance({after->score, after->bookId}, {score, bookId}))) {
+            scored.emplace_back(score, bookId);
         }
     }
+    size_t count = std::min(limit, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + count, scored.end(), byRelevance);
     
-    std::sort(results.begin(), results.end());
-    
-    if (results.size() > limit) {
-        results.resize(limit);
+    results.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        results.push_back({CopyRowLocked(catalog.at(scored[i].second)), scored[i].first});
     }
     
     std::cout << "Found " << results.size() << " results" << std::endl;
     return results;
-}
\ No newline at end of file
+}
@@ -1,15 +1,32 @@
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fstream>
-#include <sys/file.h>
-#include <fcntl.h>
-#include <unistd.h>
 
 #include "../Interfaces/Categories.hpp"
+#include "../Interfaces/Books.hpp"
+#include "../Utils/IdSequence.hpp"
+#include "../Utils/StoreFile.hpp"
+#include "../Utils/JsonRecordReader.hpp"
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
+namespace {
+    struct CategoryDecoder {
+        using Record = CategoryDto;
+
+        static void Set(CategoryDto& category, const std::string& field, const std::string&,
+                        const Utils::JsonValue& value) {
+            if (field == "CategoryId") category.CategoryId = value.Int();
+            else if (field == "Name") category.Name = value.TakeString();
+            else if (field == "Description") category.Description = value.TakeString();
+            else if (field == "DateCreated") category.DateCreated = value.Time();
+        }
+        static void BeginElement(CategoryDto&, const std::string&) {}
+        static void Finish(CategoryDto&) {}
+    };
+}
+
 Categories::Categories() {
     filename = "./resources/database/categories.json";
     fs::create_directories("./resources/database");
@@ -18,54 +35,49 @@ Categories::Categories() {
         file << "[]";
         file.close();
     }
+    LoadTable();
 }
 
-Categories::Categories(const std::string& fname) : filename(fname) {}
+Categories::Categories(const std::string& fname) : filename(fname) {
+    LoadTable();
+}
 
 Categories::~Categories() {}
 
+void Categories::LoadTable() {
+    std::unique_lock<std::shared_mutex> lock(tableMutex);
+    storeFile = StoreFile::For(filename);
+    table.clear();
+    try {
+        for (auto& category : LoadFromFile()) {
+            int id = category.CategoryId;
+            table[id] = std::move(category);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load categories: " << e.what() << std::endl;
+    }
+    idSequence = IdSequence::For(filename);
+    idSequence->EnsureAtLeast(table.empty() ? 1 : table.rbegin()->first + 1);
+}
+
 int Categories::GetNextCategoryId() const {
-    auto categories = LoadFromFile();
-    if (categories.empty()) return 1;
-    
-    return std::max_element(categories.begin(), categories.end(),
-        [](const CategoryDto& a, const CategoryDto& b) { 
-            return a.CategoryId < b.CategoryId; 
-        })->CategoryId + 1;
+    return idSequence->Next();
 }
 
 bool Categories::AddCategory(CategoryDto category) {
     try {
-        std::cout << "Attempting to open file: " << filename << std::endl;
-        
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) {
-            std::cerr << "Failed to open file. Error: " << strerror(errno) << std::endl;
-            return false;
-        }
-        
-        std::cout << "File opened successfully. Attempting to lock..." << std::endl;
-        
-        if (flock(fd, LOCK_EX) == -1) {
-            std::cerr << "Failed to lock file. Error: " << strerror(errno) << std::endl;
-            close(fd);
-            return false;
-        }
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
         
-        std::cout << "File locked. Loading existing categories..." << std::endl;
-        auto categories = LoadFromFile();
         category.CategoryId = GetNextCategoryId();
         category.DateCreated = std::time(nullptr);
-        std::cout << "Adding new category..." << std::endl;
-        categories.push_back(category);
-        
-        std::cout << "Saving updated categories..." << std::endl;
-        SaveToFile(categories);
-        
-        std::cout << "Unlocking and closing file..." << std::endl;
-        flock(fd, LOCK_UN);
-        close(fd);
-        
+        table[category.CategoryId] = category;
+        try {
+            SaveToFile();
+        } catch (...) {
+            table.erase(category.CategoryId);
+            throw;
+        }
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Exception in AddCategory: " << e.what() << std::endl;
@@ -78,49 +90,65 @@ bool Categories::AddCategory(CategoryDto category) {
 
 bool Categories::RemoveCategory(int categoryId) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
         
-        flock(fd, LOCK_EX);
-        auto categories = LoadFromFile();
-        
-        auto it = std::remove_if(categories.begin(), categories.end(),
-            [categoryId](const CategoryDto& cat) { return cat.CategoryId == categoryId; });
-        
-        if (it != categories.end()) {
-            categories.erase(it, categories.end());
-            SaveToFile(categories);
+        auto it = table.find(categoryId);
+        if (it != table.end()) {
+            CategoryDto removed = std::move(it->second);
+            table.erase(it);
+            try {
+                SaveToFile();
+            } catch (...) {
+                table[categoryId] = std::move(removed);
+                return false;
+            }
         }
         
-        flock(fd, LOCK_UN);
-        close(fd);
         return true;
     } catch (...) {
         return false;
     }
 }
 
+bool Categories::RemoveCategory(int categoryId, Books& books) {
+    return books.DetachCategory(categoryId) && RemoveCategory(categoryId);
+}
+
 std::vector<CategoryDto> Categories::GetAllCategories() {
-    int fd = open(filename.c_str(), O_RDONLY);
-    if (fd == -1) return {};
-    
-    flock(fd, LOCK_SH);
-    auto categories = LoadFromFile();
-    flock(fd, LOCK_UN);
-    close(fd);
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    std::vector<CategoryDto> categories;
+    categories.reserve(table.size());
+    for (const auto& entry : table) {
+        categories.push_back(entry.second);
+    }
     return categories;
 }
 
 CategoryDto Categories::GetCategoryById(int id) {
-    auto categories = GetAllCategories();
-    auto it = std::find_if(categories.begin(), categories.end(),
-        [id](const CategoryDto& cat) { return cat.CategoryId == id; });
-    return it != categories.end() ? *it : CategoryDto{};
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    auto it = table.find(id);
+    return it != table.end() ? it->second : CategoryDto{};
+}
+
+std::vector<CategoryDto> Categories::GetCategoriesByIds(const std::vector<int>& categoryIds) {
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    std::vector<CategoryDto> categories;
+    categories.reserve(categoryIds.size());
+    for (int id : categoryIds) {
+        auto it = table.find(id);
+        if (it != table.end()) {
+            categories.push_back(it->second);
+        }
+    }
+    return categories;
 }
 
-void Categories::SaveToFile(const std::vector<CategoryDto>& categories) const {
+// Caller must hold tableMutex and a StoreFile::Lock.
+void Categories::SaveToFile() const {
     json j = json::array();
-    for (const auto& category : categories) {
+    for (const auto& entry : table) {
+        const CategoryDto& category = entry.second;
         json categoryJson;
         categoryJson["CategoryId"] = category.CategoryId;
         categoryJson["Name"] = category.Name;
@@ -129,26 +157,9 @@ void Categories::SaveToFile(const std::vector<CategoryDto>& categories) const {
         j.push_back(categoryJson);
     }
     
-    std::ofstream file(filename);
-    file << std::setw(4) << j << std::endl;
+    storeFile->Replace(j.dump(4) + "\n");
 }
 
 std::vector<CategoryDto> Categories::LoadFromFile() const {
-    std::vector<CategoryDto> categories;
-    std::ifstream file(filename);
-    if (!file.is_open()) return categories;
-    
-    json j;
-    file >> j;
-    
-    for (const auto& categoryJson : j) {
-        CategoryDto category;
-        category.CategoryId = categoryJson["CategoryId"];
-        category.Name = categoryJson["Name"];
-        category.Description = categoryJson["Description"];
-        category.DateCreated = categoryJson["DateCreated"];
-        categories.push_back(category);
-    }
-    
-    return categories;
-}
\ No newline at end of file
+    return Utils::ParseJsonRecords<CategoryDecoder>(storeFile->Read());
+}
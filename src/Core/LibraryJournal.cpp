@@ -0,0 +1,341 @@
+#include <nlohmann/json.hpp>
+#include <map>
+#include <algorithm>
+
+#include "../Interfaces/LibraryJournal.hpp"
+#include "../Utils/WriteAheadLog.hpp"
+#include "../Utils/StoreFile.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+    void AppendRows(std::string& out, const char* name, const std::vector<std::string>& rows) {
+        if (rows.empty()) return;
+        if (out.size() > 1) out += ',';
+        out += '"';
+        out += name;
+        out += "\":[";
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (i > 0) out += ',';
+            out += rows[i];
+        }
+        out += ']';
+    }
+
+    void AppendIds(std::string& out, const char* name, const std::vector<int>& ids) {
+        if (ids.empty()) return;
+        if (out.size() > 1) out += ',';
+        out += '"';
+        out += name;
+        out += "\":";
+        out += json(ids).dump();
+    }
+
+    // Throws on a malformed row so replay stops on it rather than skipping it.
+    template <typename Dto>
+    Dto DecodeOrThrow(const json& row, bool (*decode)(const std::string&, Dto&)) {
+        Dto record{};
+        if (!decode(row.dump(), record)) {
+            throw std::runtime_error("Malformed journal row");
+        }
+        return record;
+    }
+}
+
+bool JournalRecord::Empty() const {
+    return books.empty() && users.empty() && transactions.empty() &&
+           removedBooks.empty() && removedUsers.empty() && removedTransactions.empty();
+}
+
+std::string JournalRecord::Encode() const {
+    std::string out = "{";
+    AppendRows(out, "books", books);
+    AppendRows(out, "users", users);
+    AppendRows(out, "transactions", transactions);
+    AppendIds(out, "removedBooks", removedBooks);
+    AppendIds(out, "removedUsers", removedUsers);
+    AppendIds(out, "removedTransactions", removedTransactions);
+    out += '}';
+    return out;
+}
+
+void UnitOfWork::UpdateBook(int bookId, BookChange change) {
+    bookChanges.emplace_back(bookId, std::move(change));
+}
+
+void UnitOfWork::ReserveCopy(int bookId) {
+    copyChanges.emplace_back(bookId, -1);
+}
+
+void UnitOfWork::ReleaseCopy(int bookId) {
+    copyChanges.emplace_back(bookId, 1);
+}
+
+void UnitOfWork::UpdateUser(int userId, UserChange change) {
+    userChanges.emplace_back(userId, std::move(change));
+}
+
+void UnitOfWork::AddTransaction(const TransactionsDto& transaction) {
+    addedTransactions.push_back(transaction);
+}
+
+void UnitOfWork::UpdateTransaction(int transactionId, TransactionChange change) {
+    transactionChanges.emplace_back(transactionId, std::move(change));
+}
+
+LibraryJournal::LibraryJournal(const std::string& path, Books& bookStore, Users& userStore,
+                               Transactions& transactionStore, size_t checkpointAfterRecords)
+    : books(bookStore), users(userStore), transactions(transactionStore),
+      checkpointAfter(checkpointAfterRecords == 0 ? 1 : checkpointAfterRecords) {
+    // Every append is a commit, so each one is synced before it returns.
+    log = std::make_unique<WriteAheadLog>(path, 1);
+    Replay();
+
+    std::unique_lock<std::shared_mutex> bookLock(books.catalogMutex);
+    std::unique_lock<std::shared_mutex> userLock(users.directoryMutex);
+    std::unique_lock<std::shared_mutex> ledgerLock(transactions.ledgerMutex);
+    books.journal = this;
+    users.journal = this;
+    transactions.journal = this;
+    checkpointThread = std::thread(&LibraryJournal::CheckpointLoop, this);
+}
+
+LibraryJournal::~LibraryJournal() {
+    {
+        std::lock_guard<std::mutex> lock(checkpointMutex);
+        checkpointRunning = false;
+    }
+    checkpointSignal.notify_all();
+    checkpointThread.join();
+    Checkpoint();
+    std::unique_lock<std::shared_mutex> bookLock(books.catalogMutex);
+    std::unique_lock<std::shared_mutex> userLock(users.directoryMutex);
+    std::unique_lock<std::shared_mutex> ledgerLock(transactions.ledgerMutex);
+    books.journal = nullptr;
+    users.journal = nullptr;
+    transactions.journal = nullptr;
+}
+
+bool LibraryJournal::Commit(UnitOfWork& work) {
+    work.addedIds.clear();
+    work.error.clear();
+    work.outOfStock = false;
+    {
+        // Always books, then users, then transactions. Copy-count changes
+        // alone only need the rows they touch, so borrows of different titles
+        // share the catalog.
+        bool rowLevel = work.bookChanges.empty();
+        std::unique_lock<std::shared_mutex> bookLock(books.catalogMutex, std::defer_lock);
+        std::shared_lock<std::shared_mutex> bookReadLock(books.catalogMutex, std::defer_lock);
+        std::vector<std::unique_lock<std::mutex>> rowLocks;
+        if (rowLevel) {
+            bookReadLock.lock();
+            std::vector<size_t> stripes;
+            for (const auto& change : work.copyChanges) stripes.push_back(books.RowStripe(change.first));
+            std::sort(stripes.begin(), stripes.end());
+            stripes.erase(std::unique(stripes.begin(), stripes.end()), stripes.end());
+            for (size_t stripe : stripes) rowLocks.emplace_back(books.rowLocks[stripe]);
+        } else {
+            bookLock.lock();
+        }
+        // Units that leave users alone (borrow, return) do not lock them.
+        std::unique_lock<std::shared_mutex> userLock(users.directoryMutex, std::defer_lock);
+        if (!work.userChanges.empty()) userLock.lock();
+        std::unique_lock<std::shared_mutex> ledgerLock(transactions.ledgerMutex);
+
+        // Stage post-images; nothing is visible or written until all succeed.
+        std::map<int, BooksDto> bookImages;
+        for (auto& change : work.bookChanges) {
+            auto image = bookImages.find(change.first);
+            if (image == bookImages.end()) {
+                auto row = books.catalog.find(change.first);
+                if (row == books.catalog.end()) {
+                    work.error = "Error: Book " + std::to_string(change.first) + " not found";
+                    return false;
+                }
+                image = bookImages.emplace(change.first, row->second).first;
+            }
+            if (!change.second(image->second)) {
+                work.error = "Error: Change to book " + std::to_string(change.first) + " rejected";
+                return false;
+            }
+        }
+
+        for (const auto& change : work.copyChanges) {
+            auto image = bookImages.find(change.first);
+            if (image == bookImages.end()) {
+                auto row = books.catalog.find(change.first);
+                if (row == books.catalog.end()) {
+                    work.error = "Error: Book " + std::to_string(change.first) + " not found";
+                    return false;
+                }
+                image = bookImages.emplace(change.first, row->second).first;
+            }
+            if (image->second.NoOfCopies + change.second < 0) {
+                work.error = "Error: No copies of book " + std::to_string(change.first) + " left";
+                work.outOfStock = true;
+                return false;
+            }
+            image->second.NoOfCopies += change.second;
+            image->second.DateUpdated = std::time(nullptr);
+        }
+
+        std::map<int, UserDto> userImages;
+        for (auto& change : work.userChanges) {
+            auto image = userImages.find(change.first);
+            if (image == userImages.end()) {
+                auto row = users.directory.find(change.first);
+                if (row == users.directory.end()) {
+                    work.error = "Error: User " + std::to_string(change.first) + " not found";
+                    return false;
+                }
+                // Start from the live sign-in counters, not the last flushed ones.
+                image = userImages.emplace(change.first, users.WithActivityLocked(row->second)).first;
+            }
+            if (!change.second(image->second)) {
+                work.error = "Error: Change to user " + std::to_string(change.first) + " rejected";
+                return false;
+            }
+        }
+
+        std::map<int, TransactionsDto> transactionImages;
+        for (auto& change : work.transactionChanges) {
+            auto image = transactionImages.find(change.first);
+            if (image == transactionImages.end()) {
+                auto row = transactions.FindLocked(change.first);
+                if (!row) {
+                    work.error = "Error: Transaction " + std::to_string(change.first) + " not found";
+                    return false;
+                }
+                image = transactionImages.emplace(change.first, *row).first;
+            }
+            if (!change.second(image->second)) {
+                work.error = "Error: Change to transaction " + std::to_string(change.first) + " rejected";
+                return false;
+            }
+        }
+        for (auto transaction : work.addedTransactions) {
+            transactions.StampNew(transaction);
+            work.addedIds.push_back(transaction.TransactionId);
+            transactionImages[transaction.TransactionId] = transaction;
+        }
+
+        JournalRecord record;
+        for (const auto& image : bookImages) record.books.push_back(Books::EncodeRow(image.second));
+        for (const auto& image : userImages) record.users.push_back(Users::EncodeRow(image.second));
+        for (const auto& image : transactionImages) {
+            record.transactions.push_back(Transactions::EncodeRow(image.second));
+        }
+        if (!record.Empty() && !Append(record)) {
+            work.addedIds.clear();
+            work.error = "Error: Unable to access database";
+            return false;
+        }
+
+        // Durable from here on; a failure below is repaired by replay on restart.
+        try {
+            for (const auto& image : bookImages) {
+                if (rowLevel) books.ApplyCopiesLocked(image.second);
+                else books.InstallLocked(image.second);
+            }
+            for (const auto& image : userImages) users.InstallLocked(image.second);
+            for (const auto& image : transactionImages) transactions.InstallLocked(image.second);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to apply committed journal record: " << e.what() << std::endl;
+        }
+    }
+
+    if (PendingRecords() >= checkpointAfter) {
+        Checkpoint();
+    }
+    return true;
+}
+
+bool LibraryJournal::Append(const JournalRecord& record) {
+    if (!log->Append(record.Encode())) return false;
+    // The caller still holds its store lock and a checkpoint takes all of
+    // them, so it cannot run here.
+    if (log->RecordCount() >= checkpointAfter) {
+        RequestCheckpoint();
+    }
+    return true;
+}
+
+void LibraryJournal::RequestCheckpoint() {
+    {
+        std::lock_guard<std::mutex> lock(checkpointMutex);
+        checkpointWanted = true;
+    }
+    checkpointSignal.notify_one();
+}
+
+void LibraryJournal::CheckpointLoop() {
+    std::unique_lock<std::mutex> lock(checkpointMutex);
+    while (checkpointRunning) {
+        checkpointSignal.wait(lock, [this] { return !checkpointRunning || checkpointWanted; });
+        if (!checkpointWanted) continue;
+        checkpointWanted = false;
+        lock.unlock();
+        Checkpoint();
+        lock.lock();
+    }
+}
+
+void LibraryJournal::Checkpoint() {
+    // Store writers take their file lock before their store lock, so do the same.
+    StoreFile::Lock bookFileLock(*books.storeFile);
+    StoreFile::Lock userFileLock(*users.storeFile);
+    std::unique_lock<std::shared_mutex> bookLock(books.catalogMutex);
+    std::unique_lock<std::shared_mutex> userLock(users.directoryMutex);
+    std::unique_lock<std::shared_mutex> ledgerLock(transactions.ledgerMutex);
+    if (log->RecordCount() == 0) return;
+
+    // The store files must be durable before the journal backing them is
+    // dropped; SaveToFile only returns once they are.
+    try {
+        books.SaveToFile();
+        users.SaveToFile();
+        if (!transactions.CheckpointLocked()) {
+            std::cerr << "Journal checkpoint failed; keeping the journal" << std::endl;
+            return;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Journal checkpoint failed: " << e.what() << std::endl;
+        return;
+    }
+    log->Reset();
+}
+
+size_t LibraryJournal::PendingRecords() {
+    return log->RecordCount();
+}
+
+// Runs before the stores are attached, so installs go to memory only; the
+// checkpoint that follows folds them into the store files.
+void LibraryJournal::Replay() {
+    size_t replayed;
+    {
+        std::unique_lock<std::shared_mutex> bookLock(books.catalogMutex);
+        std::unique_lock<std::shared_mutex> userLock(users.directoryMutex);
+        std::unique_lock<std::shared_mutex> ledgerLock(transactions.ledgerMutex);
+        replayed = log->Replay([this](const std::string& line) {
+            json record = json::parse(line);
+            for (const auto& row : record.value("books", json::array())) {
+                books.InstallLocked(DecodeOrThrow<BooksDto>(row, &Books::DecodeRow));
+            }
+            for (const auto& row : record.value("users", json::array())) {
+                users.RestoreLocked(DecodeOrThrow<UserDto>(row, &Users::DecodeRow));
+            }
+            for (const auto& row : record.value("transactions", json::array())) {
+                transactions.InstallLocked(DecodeOrThrow<TransactionsDto>(row, &Transactions::DecodeRow));
+            }
+            for (int id : record.value("removedBooks", std::vector<int>())) books.EraseRowLocked(id);
+            for (int id : record.value("removedUsers", std::vector<int>())) users.EraseRowLocked(id);
+            for (int id : record.value("removedTransactions", std::vector<int>())) transactions.EraseLocked(id);
+        });
+    }
+    if (replayed > 0) {
+        std::cout << "Replayed " << replayed << " journal record(s)" << std::endl;
+        Checkpoint();
+    }
+}
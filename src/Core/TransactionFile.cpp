@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Interfaces/TransactionFile.hpp"
+#include "../Interfaces/Transactions.hpp"
+
+namespace {
+    const char FileMagic[8] = {'L', 'I', 'B', 'T', 'X', 'N', '\0', '\0'};
+    const uint32_t HostByteOrder = 0x01020304;
+    const size_t GrowthSlots = 4096;
+
+    TransactionRecord ToRecord(const TransactionsDto& transaction) {
+        TransactionRecord record;
+        record.TransactionId = transaction.TransactionId;
+        record.UserId = transaction.UserId;
+        record.BookId = transaction.BookId;
+        record.Status = static_cast<int32_t>(transaction.Status);
+        record.CreatedDate = transaction.CreatedDate;
+        record.BorrowDate = transaction.BorrowDate;
+        record.DueDate = transaction.DueDate;
+        record.ReturnDate = transaction.ReturnDate;
+        record.ActualReturnDate = transaction.ActualReturnDate;
+        return record;
+    }
+
+    off_t SlotOffset(size_t slot) {
+        return static_cast<off_t>(sizeof(TransactionFileHeader) + slot * sizeof(TransactionRecord));
+    }
+}
+
+TransactionFile::TransactionFile(const std::string& filePath)
+    : path(filePath), fd(-1), mapping(nullptr), mappedSize(0), slotCount(0) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat " + path);
+    }
+
+    if (st.st_size == 0) {
+        TransactionFileHeader header{};
+        std::memcpy(header.Magic, FileMagic, sizeof(FileMagic));
+        header.Version = CurrentVersion;
+        header.RecordSize = sizeof(TransactionRecord);
+        header.ByteOrder = HostByteOrder;
+        header.SlotCount = 0;
+        WriteAt(0, &header, sizeof(header));
+        st.st_size = sizeof(header);
+    } else {
+        TransactionFileHeader header{};
+        if (st.st_size < static_cast<off_t>(sizeof(header)) ||
+            pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.Magic, FileMagic, sizeof(FileMagic)) != 0) {
+            close(fd);
+            throw std::runtime_error(path + " is not a transaction file");
+        }
+        if (header.Version != CurrentVersion || header.RecordSize != sizeof(TransactionRecord) ||
+            header.ByteOrder != HostByteOrder) {
+            close(fd);
+            throw std::runtime_error(path + " has an unsupported version or byte order");
+        }
+        // A crash between growing the file and bumping the header leaves
+        // zeroed (free) slots, so the smaller of the two counts is safe.
+        size_t storedSlots = (st.st_size - sizeof(header)) / sizeof(TransactionRecord);
+        slotCount = std::min<size_t>(header.SlotCount, storedSlots);
+    }
+
+    try {
+        Map(st.st_size);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+TransactionFile::~TransactionFile() {
+    if (mapping != nullptr) {
+        munmap(const_cast<uint8_t*>(mapping), mappedSize);
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+}
+
+size_t TransactionFile::SlotCount() const {
+    return slotCount;
+}
+
+bool TransactionFile::IsLive(size_t slot) const {
+    return slot < slotCount && RecordAt(slot).TransactionId != 0;
+}
+
+TransactionsDto TransactionFile::Read(size_t slot) const {
+    const TransactionRecord& record = RecordAt(slot);
+    TransactionsDto transaction;
+    transaction.TransactionId = record.TransactionId;
+    transaction.UserId = record.UserId;
+    transaction.BookId = record.BookId;
+    transaction.Status = static_cast<BorrowStatus>(record.Status);
+    transaction.CreatedDate = record.CreatedDate;
+    transaction.BorrowDate = record.BorrowDate;
+    transaction.DueDate = record.DueDate;
+    transaction.ReturnDate = record.ReturnDate;
+    transaction.ActualReturnDate = record.ActualReturnDate;
+    return transaction;
+}
+
+void TransactionFile::Write(size_t slot, const TransactionsDto& transaction) {
+    if (slot >= slotCount) {
+        throw std::out_of_range("Transaction slot out of range");
+    }
+    TransactionRecord record = ToRecord(transaction);
+    WriteAt(SlotOffset(slot), &record, sizeof(record));
+}
+
+size_t TransactionFile::Append(const TransactionsDto& transaction) {
+    size_t slot = slotCount;
+    Reserve(slot + 1);
+    TransactionRecord record = ToRecord(transaction);
+    WriteAt(SlotOffset(slot), &record, sizeof(record));
+
+    uint64_t newCount = slot + 1;
+    WriteAt(offsetof(TransactionFileHeader, SlotCount), &newCount, sizeof(newCount));
+    slotCount = slot + 1;
+    return slot;
+}
+
+void TransactionFile::Clear(size_t slot) {
+    if (slot >= slotCount) return;
+    TransactionRecord record{};
+    WriteAt(SlotOffset(slot), &record, sizeof(record));
+}
+
+bool TransactionFile::Sync() {
+    return fdatasync(fd) == 0;
+}
+
+const TransactionRecord& TransactionFile::RecordAt(size_t slot) const {
+    return *reinterpret_cast<const TransactionRecord*>(mapping + SlotOffset(slot));
+}
+
+void TransactionFile::WriteAt(off_t offset, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = pwrite(fd, bytes + written, size - written, offset + written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("Failed to write " + path);
+        written += n;
+    }
+}
+
+// Grows the file (and the mapping) so that at least `slots` records fit.
+void TransactionFile::Reserve(size_t slots) {
+    size_t needed = SlotOffset(slots);
+    if (needed <= mappedSize) return;
+
+    size_t grown = SlotOffset(std::max(slots, slotCount + GrowthSlots));
+    if (ftruncate(fd, grown) != 0) {
+        throw std::runtime_error("Failed to grow " + path);
+    }
+    Map(grown);
+}
+
+void TransactionFile::Map(size_t size) {
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("Failed to map " + path);
+    }
+    if (mapping != nullptr) {
+        munmap(const_cast<uint8_t*>(mapping), mappedSize);
+    }
+    mapping = static_cast<const uint8_t*>(mapped);
+    mappedSize = size;
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+
+#include "../Interfaces/TransactionIndex.hpp"
+#include "../Interfaces/Transactions.hpp"
+
+namespace {
+    const std::time_t SecondsPerDay = 24 * 60 * 60;
+
+    std::time_t DayOf(std::time_t date) {
+        return date >= 0 ? date / SecondsPerDay : (date - SecondsPerDay + 1) / SecondsPerDay;
+    }
+
+    // Ledger order means most inserts land at the end, which is a push_back.
+    template <typename T>
+    void InsertSorted(std::vector<T>& values, const T& value) {
+        if (values.empty() || values.back() < value) {
+            values.push_back(value);
+            return;
+        }
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        if (it == values.end() || !(*it == value)) {
+            values.insert(it, value);
+        }
+    }
+
+    template <typename T>
+    void EraseSorted(std::vector<T>& values, const T& value) {
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        if (it != values.end() && *it == value) {
+            values.erase(it);
+        }
+    }
+
+    // Drops the status once its last id goes, so empty sets don't pile up.
+    template <typename Postings>
+    void RemoveStatus(Postings& postings, int status, int id) {
+        auto it = postings.find(status);
+        if (it == postings.end()) return;
+        it->second.erase(id);
+        if (it->second.empty()) {
+            postings.erase(it);
+        }
+    }
+
+    const std::vector<int> NoIds;
+    const std::set<int> NoStatusIds;
+}
+
+void TransactionIndex::Add(const TransactionsDto& transaction) {
+    int id = transaction.TransactionId;
+
+    UserEntries& user = byUser[transaction.UserId];
+    InsertSorted(user.Ids, id);
+    user.Loans.insert(LoanEntry{transaction.BookId, static_cast<int>(transaction.Status), id});
+    user.IdsByStatus[transaction.Status].insert(id);
+    InsertSorted(user.BorrowDates, DatedId{transaction.BorrowDate, id});
+    InsertSorted(user.DueDates, DatedId{transaction.DueDate, id});
+
+    InsertSorted(byBook[transaction.BookId], id);
+    byStatus[transaction.Status].insert(id);
+    AddDated(borrowDays, DatedId{transaction.BorrowDate, id});
+    AddDated(dueDays, DatedId{transaction.DueDate, id});
+}
+
+void TransactionIndex::Remove(const TransactionsDto& transaction) {
+    int id = transaction.TransactionId;
+
+    auto user = byUser.find(transaction.UserId);
+    if (user != byUser.end()) {
+        EraseSorted(user->second.Ids, id);
+        user->second.Loans.erase(LoanEntry{transaction.BookId, static_cast<int>(transaction.Status), id});
+        RemoveStatus(user->second.IdsByStatus, transaction.Status, id);
+        EraseSorted(user->second.BorrowDates, DatedId{transaction.BorrowDate, id});
+        EraseSorted(user->second.DueDates, DatedId{transaction.DueDate, id});
+        if (user->second.Ids.empty()) {
+            byUser.erase(user);
+        }
+    }
+
+    auto book = byBook.find(transaction.BookId);
+    if (book != byBook.end()) {
+        EraseSorted(book->second, id);
+        if (book->second.empty()) {
+            byBook.erase(book);
+        }
+    }
+
+    RemoveStatus(byStatus, transaction.Status, id);
+    RemoveDated(borrowDays, DatedId{transaction.BorrowDate, id});
+    RemoveDated(dueDays, DatedId{transaction.DueDate, id});
+}
+
+void TransactionIndex::Update(const TransactionsDto& previous, const TransactionsDto& current) {
+    int id = current.TransactionId;
+    if (previous.TransactionId != id || previous.UserId != current.UserId) {
+        Remove(previous);
+        Add(current);
+        return;
+    }
+
+    UserEntries& user = byUser[current.UserId];
+    if (previous.BookId != current.BookId || previous.Status != current.Status) {
+        user.Loans.erase(LoanEntry{previous.BookId, static_cast<int>(previous.Status), id});
+        user.Loans.insert(LoanEntry{current.BookId, static_cast<int>(current.Status), id});
+    }
+    if (previous.Status != current.Status) {
+        RemoveStatus(user.IdsByStatus, previous.Status, id);
+        user.IdsByStatus[current.Status].insert(id);
+        RemoveStatus(byStatus, previous.Status, id);
+        byStatus[current.Status].insert(id);
+    }
+    if (previous.BookId != current.BookId) {
+        auto book = byBook.find(previous.BookId);
+        if (book != byBook.end()) {
+            EraseSorted(book->second, id);
+            if (book->second.empty()) {
+                byBook.erase(book);
+            }
+        }
+        InsertSorted(byBook[current.BookId], id);
+    }
+    if (previous.BorrowDate != current.BorrowDate) {
+        EraseSorted(user.BorrowDates, DatedId{previous.BorrowDate, id});
+        InsertSorted(user.BorrowDates, DatedId{current.BorrowDate, id});
+        RemoveDated(borrowDays, DatedId{previous.BorrowDate, id});
+        AddDated(borrowDays, DatedId{current.BorrowDate, id});
+    }
+    if (previous.DueDate != current.DueDate) {
+        EraseSorted(user.DueDates, DatedId{previous.DueDate, id});
+        InsertSorted(user.DueDates, DatedId{current.DueDate, id});
+        RemoveDated(dueDays, DatedId{previous.DueDate, id});
+        AddDated(dueDays, DatedId{current.DueDate, id});
+    }
+}
+
+void TransactionIndex::Clear() {
+    byUser.clear();
+    byBook.clear();
+    byStatus.clear();
+    borrowDays.clear();
+    dueDays.clear();
+}
+
+const std::vector<int>& TransactionIndex::ByUser(int userId) const {
+    auto it = byUser.find(userId);
+    return it != byUser.end() ? it->second.Ids : NoIds;
+}
+
+const std::vector<int>& TransactionIndex::ByBook(int bookId) const {
+    auto it = byBook.find(bookId);
+    return it != byBook.end() ? it->second : NoIds;
+}
+
+const std::set<int>& TransactionIndex::ByStatus(BorrowStatus status) const {
+    auto it = byStatus.find(status);
+    return it != byStatus.end() ? it->second : NoStatusIds;
+}
+
+int TransactionIndex::FindLoan(int userId, int bookId, BorrowStatus status) const {
+    auto user = byUser.find(userId);
+    if (user == byUser.end()) return 0;
+
+    const auto& loans = user->second.Loans;
+    LoanEntry first{bookId, static_cast<int>(status), 0};
+    auto it = loans.lower_bound(first);
+    if (it == loans.end() || it->BookId != bookId || it->Status != first.Status) return 0;
+    return it->TransactionId;
+}
+
+std::vector<int> TransactionIndex::ByUserAndStatus(int userId, BorrowStatus status, int afterId,
+                                                    size_t limit) const {
+    std::vector<int> ids;
+    auto user = byUser.find(userId);
+    if (user == byUser.end()) return ids;
+    auto matching = user->second.IdsByStatus.find(status);
+    if (matching == user->second.IdsByStatus.end()) return ids;
+    for (auto it = matching->second.upper_bound(afterId);
+         it != matching->second.end() && ids.size() < limit; ++it) {
+        ids.push_back(*it);
+    }
+    return ids;
+}
+
+size_t TransactionIndex::CountByUserAndStatus(int userId, BorrowStatus status) const {
+    auto user = byUser.find(userId);
+    if (user == byUser.end()) return 0;
+    auto matching = user->second.IdsByStatus.find(status);
+    return matching != user->second.IdsByStatus.end() ? matching->second.size() : 0;
+}
+
+std::vector<int> TransactionIndex::BorrowedBetween(std::time_t startDate, std::time_t endDate) const {
+    return Range(borrowDays, startDate, endDate);
+}
+
+std::vector<int> TransactionIndex::DueBetween(std::time_t startDate, std::time_t endDate) const {
+    return Range(dueDays, startDate, endDate);
+}
+
+std::vector<int> TransactionIndex::BorrowedBetween(int userId, std::time_t startDate, std::time_t endDate) const {
+    std::vector<int> ids;
+    auto it = byUser.find(userId);
+    if (it != byUser.end()) {
+        CollectRange(it->second.BorrowDates, startDate, endDate, ids);
+    }
+    return ids;
+}
+
+std::vector<int> TransactionIndex::DueBetween(int userId, std::time_t startDate, std::time_t endDate) const {
+    std::vector<int> ids;
+    auto it = byUser.find(userId);
+    if (it != byUser.end()) {
+        CollectRange(it->second.DueDates, startDate, endDate, ids);
+    }
+    return ids;
+}
+
+void TransactionIndex::AddDated(std::map<std::time_t, DateRun>& days, const DatedId& entry) {
+    InsertSorted(days[DayOf(entry.Date)], entry);
+}
+
+void TransactionIndex::RemoveDated(std::map<std::time_t, DateRun>& days, const DatedId& entry) {
+    auto day = days.find(DayOf(entry.Date));
+    if (day == days.end()) return;
+    EraseSorted(day->second, entry);
+    if (day->second.empty()) {
+        days.erase(day);
+    }
+}
+
+// One seek to the first entry at or after startDate, then a contiguous walk.
+void TransactionIndex::CollectRange(const DateRun& run, std::time_t startDate, std::time_t endDate,
+                                    std::vector<int>& ids) {
+    auto it = std::lower_bound(run.begin(), run.end(), DatedId{startDate, 0},
+        [](const DatedId& entry, const DatedId& bound) { return entry.Date < bound.Date; });
+    for (; it != run.end() && it->Date <= endDate; ++it) {
+        ids.push_back(it->TransactionId);
+    }
+}
+
+std::vector<int> TransactionIndex::Range(const std::map<std::time_t, DateRun>& days,
+                                         std::time_t startDate, std::time_t endDate) {
+    std::vector<int> ids;
+    if (startDate > endDate) return ids;
+    auto last = days.upper_bound(DayOf(endDate));
+    for (auto day = days.lower_bound(DayOf(startDate)); day != last; ++day) {
+        CollectRange(day->second, startDate, endDate, ids);
+    }
+    return ids;
+}
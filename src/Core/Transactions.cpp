@@ -1,17 +1,86 @@
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fstream>
-#include <sys/file.h>
+#include <optional>
+#include <cstdio>
+#include <stdexcept>
 #include <fcntl.h>
 #include <unistd.h>
-#include <optional>
 
 #include "../Interfaces/Transactions.hpp"
+#include "../Interfaces/LibraryJournal.hpp"
+#include "../Utils/WriteAheadLog.hpp"
+#include "../Interfaces/TransactionFile.hpp"
+#include "../Utils/IdSequence.hpp"
+#include "../Utils/StoreFile.hpp"
+#include "../Utils/JsonRecordReader.hpp"
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
-Transactions::Transactions() {
+namespace {
+    json TransactionToJson(const TransactionsDto& transaction) {
+        json transactionJson;
+        transactionJson["TransactionId"] = transaction.TransactionId;
+        transactionJson["UserId"] = transaction.UserId;
+        transactionJson["BookId"] = transaction.BookId;
+        transactionJson["CreatedDate"] = transaction.CreatedDate;
+        transactionJson["BorrowDate"] = transaction.BorrowDate;
+        transactionJson["DueDate"] = transaction.DueDate;
+        transactionJson["ReturnDate"] = transaction.ReturnDate;
+        transactionJson["ActualReturnDate"] = transaction.ActualReturnDate;
+        transactionJson["Status"] = static_cast<int>(transaction.Status);
+        return transactionJson;
+    }
+
+    TransactionsDto TransactionFromJson(const json& transactionJson) {
+        TransactionsDto transaction;
+        transaction.TransactionId = transactionJson["TransactionId"];
+        transaction.UserId = transactionJson["UserId"];
+        transaction.BookId = transactionJson["BookId"];
+        transaction.BorrowDate = transactionJson["BorrowDate"];
+        transaction.CreatedDate = transactionJson.value("CreatedDate", transaction.BorrowDate);
+        transaction.DueDate = transactionJson["DueDate"];
+        transaction.ReturnDate = transactionJson["ReturnDate"];
+        transaction.ActualReturnDate = transactionJson["ActualReturnDate"];
+        transaction.Status = static_cast<BorrowStatus>(transactionJson["Status"]);
+        return transaction;
+    }
+
+    // Makes a rename into the directory durable.
+    bool SyncParentDirectory(const std::string& path) {
+        std::string directory = fs::path(path).parent_path().string();
+        int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1) return false;
+        bool synced = fsync(fd) == 0;
+        close(fd);
+        return synced;
+    }
+
+    struct TransactionDecoder {
+        using Record = TransactionsDto;
+
+        static void Set(TransactionsDto& transaction, const std::string& field, const std::string&,
+                        const Utils::JsonValue& value) {
+            if (field == "TransactionId") transaction.TransactionId = value.Int();
+            else if (field == "UserId") transaction.UserId = value.Int();
+            else if (field == "BookId") transaction.BookId = value.Int();
+            else if (field == "CreatedDate") transaction.CreatedDate = value.Time();
+            else if (field == "BorrowDate") transaction.BorrowDate = value.Time();
+            else if (field == "DueDate") transaction.DueDate = value.Time();
+            else if (field == "ReturnDate") transaction.ReturnDate = value.Time();
+            else if (field == "ActualReturnDate") transaction.ActualReturnDate = value.Time();
+            else if (field == "Status") transaction.Status = static_cast<BorrowStatus>(value.Int());
+        }
+        static void BeginElement(TransactionsDto&, const std::string&) {}
+        // Snapshots written before CreatedDate existed fall back to BorrowDate.
+        static void Finish(TransactionsDto& transaction) {
+            if (transaction.CreatedDate == 0) transaction.CreatedDate = transaction.BorrowDate;
+        }
+    };
+}
+
+Transactions::Transactions() : mode(StorageMode::SNAPSHOT) {
     filename = "./resources/database/transactions.json";
     fs::create_directories("./resources/database");
     if (!fs::exists(filename)) {
@@ -19,30 +88,305 @@ Transactions::Transactions() {
         file << "[]";
         file.close();
     }
+    LoadLedger();
 }
 
-Transactions::Transactions(const std::string& fname) : filename(fname) {}
+Transactions::Transactions(const std::string& fname, StorageMode storageMode)
+    : filename(fname), mode(storageMode) {
+    LoadLedger();
+}
 
 Transactions::~Transactions() {}
 
+void Transactions::LoadLedger() {
+    std::unique_lock<std::shared_mutex> lock(ledgerMutex);
+    ledger.clear();
+    index.Clear();
+    indexed = false;
+    if (mode == StorageMode::BINARY) {
+        LoadRecords();
+        return;
+    }
+    storeFile = StoreFile::For(filename);
+    try {
+        LoadFromFile();
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load transactions snapshot: " << e.what() << std::endl;
+    }
+
+    if (mode == StorageMode::WRITE_AHEAD_LOG) {
+        ReplayLog();
+    } else if (fs::exists(filename + ".wal") && fs::file_size(filename + ".wal") > 0) {
+        // Left by an earlier run in WRITE_AHEAD_LOG mode; fold it into the
+        // snapshot so switching modes loses nothing.
+        ReplayLog();
+        if (WriteSnapshotLocked()) wal->Reset();
+        wal.reset();
+    }
+    idSequence = IdSequence::For(filename);
+    idSequence->EnsureAtLeast(ledger.empty() ? 1 : ledger.rbegin()->first + 1);
+}
+
+// Caller must hold ledgerMutex exclusively. Maps the record file and notes
+// where each live id sits; the rows themselves are never copied into memory.
+void Transactions::LoadRecords() {
+    records = std::make_unique<TransactionFile>(filename);
+    slotOf.clear();
+    freeSlots.clear();
+    liveRecords = 0;
+    for (size_t slot = 0; slot < records->SlotCount(); slot++) {
+        if (!records->IsLive(slot)) {
+            freeSlots.push_back(slot);
+            continue;
+        }
+        TransactionsDto transaction = records->Read(slot);
+        if (transaction.TransactionId <= 0) continue;
+        if (static_cast<size_t>(transaction.TransactionId) >= slotOf.size()) {
+            slotOf.resize(transaction.TransactionId + 1, NoSlot);
+        }
+        slotOf[transaction.TransactionId] = static_cast<uint32_t>(slot);
+        liveRecords++;
+    }
+    idSequence = IdSequence::For(filename);
+    idSequence->EnsureAtLeast(slotOf.empty() ? 1 : static_cast<int>(slotOf.size()));
+}
+
+// Caller must hold ledgerMutex.
+std::optional<size_t> Transactions::SlotLocked(int transactionId) const {
+    if (transactionId <= 0 || static_cast<size_t>(transactionId) >= slotOf.size() ||
+        slotOf[transactionId] == NoSlot) {
+        return std::nullopt;
+    }
+    return slotOf[transactionId];
+}
+
+// Caller must hold ledgerMutex.
+std::optional<TransactionsDto> Transactions::FindLocked(int transactionId) const {
+    if (mode == StorageMode::BINARY) {
+        auto slot = SlotLocked(transactionId);
+        if (!slot) return std::nullopt;
+        return records->Read(*slot);
+    }
+    auto it = ledger.find(transactionId);
+    if (it == ledger.end()) return std::nullopt;
+    return it->second;
+}
+
+// Caller must hold ledgerMutex; transactionId must exist.
+TransactionsDto Transactions::ReadLocked(int transactionId) const {
+    if (mode == StorageMode::BINARY) {
+        return records->Read(SlotLocked(transactionId).value());
+    }
+    return ledger.at(transactionId);
+}
+
+// Caller must hold ledgerMutex exclusively. Keeps the indexes, once built, in
+// step with the ledger. In BINARY mode the record is written in place here, so a failed
+// write leaves both the file and the indexes untouched.
+void Transactions::PutLocked(const TransactionsDto& transaction) {
+    if (mode == StorageMode::BINARY) {
+        if (transaction.TransactionId <= 0) {
+            throw std::invalid_argument("Transaction id must be positive");
+        }
+        auto slot = SlotLocked(transaction.TransactionId);
+        if (slot) {
+            TransactionsDto previous = records->Read(*slot);
+            records->Write(*slot, transaction);
+            if (indexed) index.Update(previous, transaction);
+            return;
+        }
+
+        size_t target;
+        if (!freeSlots.empty()) {
+            target = freeSlots.back();
+            records->Write(target, transaction);
+            freeSlots.pop_back();
+        } else {
+            target = records->Append(transaction);
+        }
+        if (static_cast<size_t>(transaction.TransactionId) >= slotOf.size()) {
+            slotOf.resize(transaction.TransactionId + 1, NoSlot);
+        }
+        slotOf[transaction.TransactionId] = static_cast<uint32_t>(target);
+        liveRecords++;
+        if (indexed) index.Add(transaction);
+        return;
+    }
+
+    auto it = ledger.find(transaction.TransactionId);
+    if (it != ledger.end()) {
+        if (indexed) index.Update(it->second, transaction);
+        it->second = transaction;
+        return;
+    }
+    ledger[transaction.TransactionId] = transaction;
+    if (indexed) index.Add(transaction);
+}
+
+// Caller must hold ledgerMutex exclusively.
+void Transactions::EraseLocked(int transactionId) {
+    if (mode == StorageMode::BINARY) {
+        auto slot = SlotLocked(transactionId);
+        if (!slot) return;
+        TransactionsDto removed = records->Read(*slot);
+        records->Clear(*slot);
+        if (indexed) index.Remove(removed);
+        freeSlots.push_back(*slot);
+        slotOf[transactionId] = NoSlot;
+        liveRecords--;
+        return;
+    }
+    auto it = ledger.find(transactionId);
+    if (it == ledger.end()) return;
+    if (indexed) index.Remove(it->second);
+    ledger.erase(it);
+}
+
+// Caller must hold ledgerMutex, shared or exclusive. Writers need the exclusive
+// lock, so the first readers to get here only race each other for the build.
+const TransactionIndex& Transactions::IndexLocked() {
+    if (indexed.load(std::memory_order_acquire)) return index;
+    std::lock_guard<std::mutex> build(indexBuildMutex);
+    if (!indexed.load(std::memory_order_relaxed)) {
+        if (mode == StorageMode::BINARY) {
+            for (uint32_t slot : slotOf) {
+                if (slot != NoSlot) index.Add(records->Read(slot));
+            }
+        } else {
+            for (const auto& entry : ledger) index.Add(entry.second);
+        }
+        indexed.store(true, std::memory_order_release);
+    }
+    return index;
+}
+
+// Caller must hold ledgerMutex.
+template <typename Ids>
+std::vector<TransactionsDto> Transactions::CollectLocked(const Ids& transactionIds) const {
+    std::vector<TransactionsDto> result;
+    result.reserve(transactionIds.size());
+    for (int id : transactionIds) {
+        result.push_back(ReadLocked(id));
+    }
+    return result;
+}
+
+// Caller must hold ledgerMutex.
+void Transactions::ReplayLog() {
+    wal = std::make_unique<WriteAheadLog>(filename + ".wal");
+    size_t replayed = wal->Replay([this](const std::string& line) {
+        json record = json::parse(line);
+        if (record["op"] == "del") {
+            EraseLocked(record["TransactionId"].get<int>());
+        } else {
+            PutLocked(TransactionFromJson(record));
+        }
+    });
+    if (replayed > 0) {
+        std::cout << "Replayed " << replayed << " transaction log record(s)" << std::endl;
+    }
+}
+
+// Caller must hold ledgerMutex exclusively and have already applied the change
+// to the ledger.
+bool Transactions::Persist(const TransactionsDto* changed, int removedId) {
+    if (journal != nullptr) {
+        JournalRecord record;
+        if (changed != nullptr) {
+            record.transactions.push_back(EncodeRow(*changed));
+        } else {
+            record.removedTransactions.push_back(removedId);
+        }
+        return journal->Append(record);
+    }
+    if (mode == StorageMode::BINARY) {
+        return records->Sync();  // PutLocked/EraseLocked already wrote the record in place
+    }
+    if (mode == StorageMode::WRITE_AHEAD_LOG) {
+        json record;
+        if (changed != nullptr) {
+            record = TransactionToJson(*changed);
+            record["op"] = "put";
+        } else {
+            record["op"] = "del";
+            record["TransactionId"] = removedId;
+        }
+        if (!wal->Append(record.dump())) return false;
+        if (wal->RecordCount() >= CompactAfterRecords) {
+            CompactLocked();
+        }
+        return true;
+    }
+
+    return WriteSnapshotLocked();
+}
+
+bool Transactions::Compact() {
+    std::unique_lock<std::shared_mutex> lock(ledgerMutex);
+    return CompactLocked();
+}
+
+bool Transactions::CompactLocked() {
+    if (mode != StorageMode::WRITE_AHEAD_LOG) return true;
+    return WriteSnapshotLocked() && wal->Reset();
+}
+
+// Caller must hold ledgerMutex. Replaces the snapshot with the ledger and
+// makes it durable before returning.
+bool Transactions::WriteSnapshotLocked() {
+    try {
+        StoreFile::Lock fileLock(*storeFile);
+        SaveToFile();
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Caller must hold ledgerMutex exclusively. Makes the ledger durable in the
+// store's own files, as a journal checkpoint requires.
+bool Transactions::CheckpointLocked() {
+    if (mode == StorageMode::BINARY) {
+        return records->Sync();
+    }
+    if (mode == StorageMode::WRITE_AHEAD_LOG) {
+        return CompactLocked();
+    }
+    return WriteSnapshotLocked();
+}
+
+// Assigns a new transaction its id and loan dates.
+void Transactions::StampNew(TransactionsDto& transaction) const {
+    transaction.TransactionId = GetNextTransactionId();
+    transaction.BorrowDate = std::time(nullptr);
+    transaction.CreatedDate = std::time(nullptr);
+    transaction.DueDate = std::time(nullptr) + (5 * 24 * 60 * 60);
+}
+
+// Caller must hold ledgerMutex exclusively.
+void Transactions::InstallLocked(const TransactionsDto& transaction) {
+    PutLocked(transaction);
+    idSequence->EnsureAtLeast(transaction.TransactionId + 1);
+}
+
+std::string Transactions::EncodeRow(const TransactionsDto& transaction) {
+    return TransactionToJson(transaction).dump();
+}
+
+bool Transactions::DecodeRow(const std::string& row, TransactionsDto& transaction) {
+    return Utils::ParseJsonRecord<TransactionDecoder>(row, transaction);
+}
+
 std::string Transactions::AddTransaction(TransactionsDto transaction) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return "Error: Unable to access database";
-        
-        flock(fd, LOCK_EX);
-        auto transactions = LoadFromFile();
-        
-        transaction.TransactionId = GetNextTransactionId();
-        transaction.BorrowDate = std::time(nullptr);
-        transaction.CreatedDate = std::time(nullptr);
-        transaction.DueDate = std::time(nullptr) + (5 * 24 * 60 * 60);
+        std::unique_lock<std::shared_mutex> lock(ledgerMutex);
         
-        transactions.push_back(transaction);
-        SaveToFile(transactions);
-        
-        flock(fd, LOCK_UN);
-        close(fd);
+        StampNew(transaction);
+        PutLocked(transaction);
+        if (!Persist(&transaction, 0)) {
+            EraseLocked(transaction.TransactionId);
+            return "Error: Unable to access database";
+        }
         return "success";
     } catch (...) {
         return "Error: Failed to add transaction";
@@ -51,24 +395,16 @@ std::string Transactions::AddTransaction(TransactionsDto transaction) {
 
 std::string Transactions::UpdateTransaction(TransactionsDto transaction) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return "Error: Unable to access database";
+        std::unique_lock<std::shared_mutex> lock(ledgerMutex);
         
-        flock(fd, LOCK_EX);
-        auto transactions = LoadFromFile();
-        
-        auto it = std::find_if(transactions.begin(), transactions.end(),
-            [&transaction](const TransactionsDto& t) { 
-                return t.TransactionId == transaction.TransactionId; 
-            });
-            
-        if (it != transactions.end()) {
-            *it = transaction;
-            SaveToFile(transactions);
+        auto previous = FindLocked(transaction.TransactionId);
+        if (previous) {
+            PutLocked(transaction);
+            if (!Persist(&transaction, 0)) {
+                PutLocked(*previous);
+                return "Error: Unable to access database";
+            }
         }
-        
-        flock(fd, LOCK_UN);
-        close(fd);
         return "success";
     } catch (...) {
         return "Error: Failed to update transaction";
@@ -77,24 +413,16 @@ std::string Transactions::UpdateTransaction(TransactionsDto transaction) {
 
 std::string Transactions::RemoveTransaction(int transactionId) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return "Error: Unable to access database";
-        
-        flock(fd, LOCK_EX);
-        auto transactions = LoadFromFile();
+        std::unique_lock<std::shared_mutex> lock(ledgerMutex);
         
-        auto it = std::remove_if(transactions.begin(), transactions.end(),
-            [transactionId](const TransactionsDto& t) { 
-                return t.TransactionId == transactionId; 
-            });
-            
-        if (it != transactions.end()) {
-            transactions.erase(it, transactions.end());
-            SaveToFile(transactions);
+        auto removed = FindLocked(transactionId);
+        if (removed) {
+            EraseLocked(transactionId);
+            if (!Persist(nullptr, transactionId)) {
+                PutLocked(*removed);
+                return "Error: Unable to access database";
+            }
         }
-        
-        flock(fd, LOCK_UN);
-        close(fd);
         return "success";
     } catch (...) {
         return "Error: Failed to remove transaction";
@@ -102,173 +430,182 @@ std::string Transactions::RemoveTransaction(int transactionId) {
 }
 
 std::vector<TransactionsDto> Transactions::GetAllTransactions() {
-    try {
-        return LoadFromFile();
-    } catch (...) {
-        return std::vector<TransactionsDto>();
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    std::vector<TransactionsDto> result;
+    if (mode == StorageMode::BINARY) {
+        result.reserve(liveRecords);
+        for (uint32_t slot : slotOf) {
+            if (slot != NoSlot) {
+                result.push_back(records->Read(slot));
+            }
+        }
+        return result;
+    }
+    result.reserve(ledger.size());
+    for (const auto& entry : ledger) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+std::vector<TransactionsDto> Transactions::GetTransactionsPage(int afterId, size_t limit) {
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    std::vector<TransactionsDto> result;
+    if (mode == StorageMode::BINARY) {
+        size_t first = afterId < 0 ? 0 : static_cast<size_t>(afterId) + 1;
+        for (size_t id = first; id < slotOf.size() && result.size() < limit; id++) {
+            if (slotOf[id] != NoSlot) {
+                result.push_back(records->Read(slotOf[id]));
+            }
+        }
+        return result;
+    }
+    for (auto it = ledger.upper_bound(afterId); it != ledger.end() && result.size() < limit; ++it) {
+        result.push_back(it->second);
     }
+    return result;
 }
 
 TransactionsDto Transactions::GetTransactionById(int transactionId) {
-    auto transactions = LoadFromFile();
-    auto it = std::find_if(transactions.begin(), transactions.end(),
-        [transactionId](const TransactionsDto& t) { 
-            return t.TransactionId == transactionId; 
-        });
-    return it != transactions.end() ? *it : TransactionsDto{};
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return FindLocked(transactionId).value_or(TransactionsDto{});
 }
 
 std::vector<TransactionsDto> Transactions::GetTransactionsByUserId(int userId) {
-    std::vector<TransactionsDto> result;
-    auto transactions = LoadFromFile();
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-        [userId](const TransactionsDto& t) { return t.UserId == userId; });
-    return result;
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().ByUser(userId));
 }
 
 std::vector<TransactionsDto> Transactions::GetTransactionsByStatus(BorrowStatus status) {
-    std::vector<TransactionsDto> result;
-    auto transactions = LoadFromFile();
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-        [status](const TransactionsDto& t) { return t.Status == status; });
-    return result;
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().ByStatus(status));
+}
+
+std::vector<TransactionsDto> Transactions::GetTransactionsByUserAndStatus(int userId, BorrowStatus status,
+                                                                         int afterId, size_t limit) {
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().ByUserAndStatus(userId, status, afterId, limit));
+}
+
+size_t Transactions::CountTransactionsByUserAndStatus(int userId, BorrowStatus status) {
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return IndexLocked().CountByUserAndStatus(userId, status);
 }
 
 std::vector<TransactionsDto> Transactions::GetTransactionsByBookId(const int& bookId) {
-    std::vector<TransactionsDto> result;
-    auto transactions = LoadFromFile();
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-        [&bookId](const TransactionsDto& t) { return t.BookId == bookId; });
-    return result;
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().ByBook(bookId));
 }
 
 TransactionsDto Transactions::GetBorrowedTransactionsByUserAndBookId(const int& userId, const int& bookId) {
-    auto transactions = LoadFromFile();
-    auto it = std::find_if(transactions.begin(), transactions.end(),
-        [&](const TransactionsDto& t) { 
-            return t.UserId == userId && 
-                   t.BookId == bookId && 
-                   t.Status == BorrowStatus::BorrowStatus_BORROWED;
-        });
-        
-    if (it != transactions.end()) {
-        return *it;
-    }
-    return TransactionsDto{};
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    int transactionId = IndexLocked().FindLoan(userId, bookId, BorrowStatus::BorrowStatus_BORROWED);
+    return transactionId == 0 ? TransactionsDto{} : ReadLocked(transactionId);
 }
 
 TransactionsDto Transactions::GetReturnedTransactionsByUserAndBookId(const int& userId, const int& bookId) {
-    auto transactions = LoadFromFile();
-    auto it = std::find_if(transactions.begin(), transactions.end(),
-        [&](const TransactionsDto& t) { 
-            return t.UserId == userId && 
-                   t.BookId == bookId && 
-                   t.Status == BorrowStatus::BorrowStatus_RETURNED;
-        });
-        
-    if (it != transactions.end()) {
-        return *it;
-    }
-    return TransactionsDto{};
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    int transactionId = IndexLocked().FindLoan(userId, bookId, BorrowStatus::BorrowStatus_RETURNED);
+    return transactionId == 0 ? TransactionsDto{} : ReadLocked(transactionId);
 }
 
 std::vector<TransactionsDto> Transactions::GetTransactionsByDate(
     const std::time_t& startDate, const std::time_t& endDate) {
-    std::vector<TransactionsDto> result;
-    auto transactions = LoadFromFile();
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-        [startDate, endDate](const TransactionsDto& t) { 
-            return t.BorrowDate >= startDate && t.BorrowDate <= endDate; 
-        });
-    return result;
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().BorrowedBetween(startDate, endDate));
 }
 
 std::vector<TransactionsDto> Transactions::GetTransactionsByDateAndUserId(
     const std::time_t& startDate, const std::time_t& endDate, const int& userId) {
-    std::vector<TransactionsDto> result;
-    auto transactions = LoadFromFile();
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-        [startDate, endDate, userId](const TransactionsDto& t) { 
-            return t.UserId == userId && 
-                   t.BorrowDate >= startDate && 
-                   t.BorrowDate <= endDate; 
-        });
-    return result;
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().BorrowedBetween(userId, startDate, endDate));
 }
 
 std::vector<TransactionsDto> Transactions::GetTransactionsByDueDate(
     const std::time_t& startDate, const std::time_t& endDate) {
-    std::vector<TransactionsDto> result;
-    auto transactions = LoadFromFile();
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-        [startDate, endDate](const TransactionsDto& t) { 
-            return t.DueDate >= startDate && t.DueDate <= endDate; 
-        });
-    return result;
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().DueBetween(startDate, endDate));
 }
 
 std::vector<TransactionsDto> Transactions::GetTransactionsByDueDateAndUserId(
     const std::time_t& startDate, const std::time_t& endDate, const int& userId) {
-    std::vector<TransactionsDto> result;
-    auto transactions = LoadFromFile();
-    std::copy_if(transactions.begin(), transactions.end(), std::back_inserter(result),
-        [startDate, endDate, userId](const TransactionsDto& t) { 
-            return t.UserId == userId && 
-                   t.DueDate >= startDate && 
-                   t.DueDate <= endDate; 
-        });
-    return result;
+    std::shared_lock<std::shared_mutex> lock(ledgerMutex);
+    return CollectLocked(IndexLocked().DueBetween(userId, startDate, endDate));
 }
 
-void Transactions::SaveToFile(const std::vector<TransactionsDto>& transactions) const {
+// Caller must hold ledgerMutex and a StoreFile::Lock.
+void Transactions::SaveToFile() const {
     json j = json::array();
-    for (const auto& transaction : transactions) {
-        json transactionJson;
-        transactionJson["TransactionId"] = transaction.TransactionId;
-        transactionJson["UserId"] = transaction.UserId;
-        transactionJson["BookId"] = transaction.BookId;
-        transactionJson["BorrowDate"] = transaction.BorrowDate;
-        transactionJson["DueDate"] = transaction.DueDate;
-        transactionJson["ReturnDate"] = transaction.ReturnDate;
-        transactionJson["ActualReturnDate"] = transaction.ActualReturnDate;
-        transactionJson["Status"] = static_cast<int>(transaction.Status);
-        j.push_back(transactionJson);
+    for (const auto& entry : ledger) {
+        j.push_back(TransactionToJson(entry.second));
     }
     
-    std::ofstream file(filename);
-    file << std::setw(4) << j << std::endl;
+    storeFile->Replace(j.dump(4) + "\n");
 }
 
-std::vector<TransactionsDto> Transactions::LoadFromFile() const {
-    std::vector<TransactionsDto> transactions;
-    std::ifstream file(filename);
-    if (!file.is_open()) return transactions;
-    
-    json j;
-    file >> j;
-    
-    for (const auto& transactionJson : j) {
-        TransactionsDto transaction;
-        transaction.TransactionId = transactionJson["TransactionId"];
-        transaction.UserId = transactionJson["UserId"];
-        transaction.BookId = transactionJson["BookId"];
-        transaction.BorrowDate = transactionJson["BorrowDate"];
-        transaction.DueDate = transactionJson["DueDate"];
-        transaction.ReturnDate = transactionJson["ReturnDate"];
-        transaction.ActualReturnDate = transactionJson["ActualReturnDate"];
-        transaction.Status = static_cast<BorrowStatus>(transactionJson["Status"]);
-        transactions.push_back(transaction);
-    }
-    
-    return transactions;
+// Caller must hold ledgerMutex exclusively. Records go from the parser
+// straight into the ledger; the snapshot is never held as a whole.
+void Transactions::LoadFromFile() {
+    Utils::ForEachJsonRecord<TransactionDecoder>(storeFile->Read(), [this](TransactionsDto& transaction) {
+        PutLocked(transaction);
+        return true;
+    });
 }
 
 int Transactions::GetNextTransactionId() const {
-    auto transactions = LoadFromFile();
-    if (transactions.empty()) return 1;
-    
-    return std::max_element(transactions.begin(), transactions.end(),
-        [](const TransactionsDto& a, const TransactionsDto& b) { 
-            return a.TransactionId < b.TransactionId; 
-        })->TransactionId + 1;
-}
\ No newline at end of file
+    return idSequence->Next();
+}
+
+bool Transactions::ConvertJsonToBinary(const std::string& jsonFile, const std::string& binaryFile) {
+    std::string tempFile = binaryFile + ".tmp";
+    try {
+        std::ifstream in(jsonFile);
+        if (!in.is_open()) return false;
+
+        std::remove(tempFile.c_str());
+        {
+            TransactionFile out(tempFile);
+            Utils::ForEachJsonRecord<TransactionDecoder>(in, [&out](TransactionsDto& transaction) {
+                out.Append(transaction);
+                return true;
+            });
+            if (!out.Sync()) {
+                throw std::runtime_error("failed to sync " + tempFile);
+            }
+        }
+        if (std::rename(tempFile.c_str(), binaryFile.c_str()) != 0) {
+            throw std::runtime_error("failed to rename " + tempFile);
+        }
+        return SyncParentDirectory(binaryFile);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to convert " << jsonFile << ": " << e.what() << std::endl;
+        std::remove(tempFile.c_str());
+        return false;
+    }
+}
+
+bool Transactions::ConvertBinaryToJson(const std::string& binaryFile, const std::string& jsonFile) {
+    try {
+        if (!fs::exists(binaryFile)) return false;
+
+        json j = json::array();
+        {
+            TransactionFile in(binaryFile);
+            for (size_t slot = 0; slot < in.SlotCount(); slot++) {
+                if (in.IsLive(slot)) {
+                    j.push_back(TransactionToJson(in.Read(slot)));
+                }
+            }
+        }
+
+        // Replaced like any store write: temp file, fsync, rename, so a crash
+        // leaves the old ledger or the new one.
+        auto store = StoreFile::For(jsonFile);
+        StoreFile::Lock fileLock(*store);
+        store->Replace(j.dump(4) + "\n");
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to convert " << binaryFile << ": " << e.what() << std::endl;
+        return false;
+    }
+}
@@ -1,19 +1,67 @@
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fstream>
-#include <sys/file.h>
-#include <fcntl.h>
-#include <unistd.h>
 #include <functional>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+#include <cctype>
 
 #include "../Interfaces/Users.hpp"
-#include "../Utils/HashUtils.hpp"
+#include "../Interfaces/LibraryJournal.hpp"
+#include "../Utils/IdSequence.hpp"
+#include "../Utils/StoreFile.hpp"
+#include "../Utils/AuthPool.hpp"
+#include "../Utils/JsonRecordReader.hpp"
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
+namespace {
+    struct UserDecoder {
+        using Record = UserDto;
+
+        static void Set(UserDto& user, const std::string& field, const std::string&,
+                        const Utils::JsonValue& value) {
+            if (field == "UserId") user.UserId = value.Int();
+            else if (field == "FirstName") user.FirstName = value.TakeString();
+            else if (field == "LastName") user.LastName = value.TakeString();
+            else if (field == "PasswordHash") user.PasswordHash = value.TakeString();
+            else if (field == "Email") user.Email = value.TakeString();
+            else if (field == "Type") user.Type = static_cast<UserType>(value.Int());
+            else if (field == "Status") user.Status = static_cast<UserStatus>(value.Int());
+            else if (field == "CreatedBy") user.CreatedBy = value.TakeString();
+            else if (field == "CreatedDate") user.CreatedDate = value.Time();
+            else if (field == "UpdatedBy") user.UpdatedBy = value.TakeString();
+            else if (field == "UpdatedDate") user.UpdatedDate = value.Time();
+            else if (field == "Address") user.Address = value.TakeString();
+            else if (field == "PhoneNumber") user.PhoneNumber = value.TakeString();
+            else if (field == "AccessCount") user.AccessCount = value.Int();
+        }
+        static void BeginElement(UserDto&, const std::string&) {}
+        static void Finish(UserDto&) {}
+    };
+
+    json UserToJson(const UserDto& user) {
+        json userJson;
+        userJson["UserId"] = user.UserId;
+        userJson["FirstName"] = user.FirstName;
+        userJson["LastName"] = user.LastName;
+        userJson["PasswordHash"] = user.PasswordHash;
+        userJson["Email"] = user.Email;
+        userJson["Type"] = static_cast<int>(user.Type);
+        userJson["Status"] = static_cast<int>(user.Status);
+        userJson["CreatedBy"] = user.CreatedBy;
+        userJson["CreatedDate"] = user.CreatedDate;
+        userJson["UpdatedBy"] = user.UpdatedBy;
+        userJson["UpdatedDate"] = user.UpdatedDate;
+        userJson["Address"] = user.Address;
+        userJson["PhoneNumber"] = user.PhoneNumber;
+        userJson["AccessCount"] = user.AccessCount;
+        return userJson;
+    }
+}
+
 
 Users::Users() {
     filename = "./resources/database/users.json";
@@ -23,79 +71,127 @@ Users::Users() {
         file << "[]";
         file.close();
     }
+    LoadDirectory();
+    flushThread = std::thread(&Users::FlushLoop, this);
 }
 
-Users::Users(const std::string& fname) : filename(fname) {}
+Users::Users(const std::string& fname) : filename(fname) {
+    LoadDirectory();
+    flushThread = std::thread(&Users::FlushLoop, this);
+}
+
+Users::~Users() {
+    {
+        std::lock_guard<std::mutex> lock(dirtyMutex);
+        flushRunning = false;
+    }
+    flushSignal.notify_all();
+    flushThread.join();
+    FlushLoginActivity();
+}
 
-Users::~Users() {}
+// Emails are matched case-insensitively: "Jane@Example.com" and
+// "jane@example.com" are the same account.
+std::string Users::NormalizeEmail(const std::string& email) {
+    std::string normalized = email;
+    std::transform(normalized.begin(), normalized.end(), normalized.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return normalized;
+}
 
+void Users::LoadDirectory() {
+    std::unique_lock<std::shared_mutex> lock(directoryMutex);
+    storeFile = StoreFile::For(filename);
+    directory.clear();
+    byEmail.clear();
+    loginActivity.clear();
+    try {
+        for (auto& user : LoadFromFile()) {
+            int id = user.UserId;
+            // Should the file hold two spellings of one address, the older account wins.
+            byEmail.emplace(NormalizeEmail(user.Email), id);
+            TrackLoginLocked(user);
+            directory[id] = std::move(user);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load users: " << e.what() << std::endl;
+    }
+    idSequence = IdSequence::For(filename);
+    idSequence->EnsureAtLeast(directory.empty() ? 1 : directory.rbegin()->first + 1);
+}
+
+// Caller must hold directoryMutex.
+UserDto* Users::FindByEmailLocked(const std::string& email) {
+    auto it = byEmail.find(NormalizeEmail(email));
+    if (it == byEmail.end()) return nullptr;
+    auto user = directory.find(it->second);
+    return user != directory.end() ? &user->second : nullptr;
+}
+
+// Holds the directory lock only to look the account up; the hash is checked
+// and the attempt recorded against the account's LoginActivity, so sign-ins
+// never wait on each other or on user writes.
 std::string Users::Login(const std::string& email, const std::string& password) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return "System error: Unable to access database";
-        
-        flock(fd, LOCK_EX);
-        auto users = LoadFromFile();
-        
-        auto it = std::find_if(users.begin(), users.end(),
-            [&email](const UserDto& u) { return u.Email == email; });
+        int userId;
+        std::string salt;
+        std::string storedHash;
+        std::shared_ptr<LoginActivity> activity;
+        {
+            std::shared_lock<std::shared_mutex> lock(directoryMutex);
+            const UserDto* user = FindByEmailLocked(email);
             
-        if (it == users.end()) {
-            flock(fd, LOCK_UN);
-            close(fd);
-            return "Invalid email or password";
-        }
-        
-        if (it->Status == UserStatus::UserStatus_DELETED) {
-            flock(fd, LOCK_UN);
-            close(fd);
-            return "Account has been deleted";
-        }
-        
-        if (it->Status == UserStatus::UserStatus_INACTIVE) {
-            flock(fd, LOCK_UN);
-            close(fd);
-            return "Account is inactive. Please contact administrator";
-        }
-        
-        if (it->Status == UserStatus::UserStatus_Pending) {
-            flock(fd, LOCK_UN);
-            close(fd);
-            return "Account is pending activation";
+            if (user == nullptr) {
+                return "Invalid email or password";
+            }
+            
+            if (user->Status == UserStatus::UserStatus_DELETED) {
+                return "Account has been deleted";
+            }
+            
+            if (user->Status == UserStatus::UserStatus_INACTIVE) {
+                return "Account is inactive. Please contact administrator";
+            }
+            
+            if (user->Status == UserStatus::UserStatus_Pending) {
+                return "Account is pending activation";
+            }
+            
+            activity = loginActivity.at(user->UserId);
+            if (activity->failedAttempts >= MaxFailedLogins) {
+                return "Account locked. Too many failed attempts. Please reset password";
+            }
+            userId = user->UserId;
+            // Salted with the stored address, so any capitalisation of it signs in.
+            salt = user->Email;
+            storedHash = user->PasswordHash;
         }
         
-        
-        if (it->AccessCount >= 5) {
-            flock(fd, LOCK_UN);
-            close(fd);
-            return "Account locked. Too many failed attempts. Please reset password";
+        auto hashed = AuthPool::Shared().Hash(salt, password);
+        if (!hashed) {
+            return ServerBusy;
         }
-        
-        std::cout << "Login: Creating hash for validation..." << std::endl;
-        std::string hashedPassword = Utils::CreateSaltedHash(email, password);
-        std::cout << "Login: Generated hash: " << hashedPassword << std::endl;
-        std::cout << "Login: Stored hash: " << it->PasswordHash << std::endl;
-        if (hashedPassword != it->PasswordHash) {
-            it->AccessCount++;
-            SaveToFile(users);
+        if (*hashed != storedHash) {
+            int attempts = activity->failedAttempts.fetch_add(1) + 1;
+            MarkLoginDirty(userId);
             
-            flock(fd, LOCK_UN);
-            close(fd);
-            
-            if (it->AccessCount >= 5) {
+            if (attempts >= MaxFailedLogins) {
                 return "Account locked. Too many failed attempts. Please reset password";
             }
             return "Invalid email or password. Attempts remaining: " + 
-                   std::to_string(5 - it->AccessCount);
+                   std::to_string(MaxFailedLogins - attempts);
         }
         
-        
-        it->AccessCount = 0;
-        it->UpdatedDate = std::time(nullptr);
-        SaveToFile(users);
-        
-        flock(fd, LOCK_UN);
-        close(fd);
+        // Only clear the count if no concurrent failure has locked the account
+        // since it was checked above.
+        int attempts = activity->failedAttempts.load();
+        do {
+            if (attempts >= MaxFailedLogins) {
+                return "Account locked. Too many failed attempts. Please reset password";
+            }
+        } while (!activity->failedAttempts.compare_exchange_weak(attempts, 0));
+        activity->lastLogin = std::time(nullptr);
+        MarkLoginDirty(userId);
         return "success";
         
     } catch (...) {
@@ -103,95 +199,216 @@ std::string Users::Login(const std::string& email, const std::string& password)
     }
 }
 
-int Users::GetNextUserId() const {
-    auto users = LoadFromFile();
-    if (users.empty()) return 1;
+void Users::MarkLoginDirty(int userId) {
+    bool flushNow;
+    {
+        std::lock_guard<std::mutex> lock(dirtyMutex);
+        dirtyLogins.insert(userId);
+        flushNow = dirtyLogins.size() >= LoginFlushBatch;
+    }
+    if (flushNow) flushSignal.notify_one();
+}
+
+// Flushes whatever is pending once per interval, or sooner once a batch
+// has built up.
+void Users::FlushLoop() {
+    std::unique_lock<std::mutex> lock(dirtyMutex);
+    while (flushRunning) {
+        flushSignal.wait_for(lock, LoginFlushInterval, [this] {
+            return !flushRunning || dirtyLogins.size() >= LoginFlushBatch;
+        });
+        if (dirtyLogins.empty()) continue;
+        lock.unlock();
+        if (!FlushLoginActivity()) {
+            std::cerr << "Failed to persist login activity; will retry" << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+bool Users::FlushLoginActivity() {
+    std::set<int> pending;
+    {
+        std::lock_guard<std::mutex> lock(dirtyMutex);
+        pending.swap(dirtyLogins);
+    }
+    if (pending.empty()) return true;
     
-    return std::max_element(users.begin(), users.end(),
-        [](const UserDto& a, const UserDto& b) { 
-            return a.UserId < b.UserId; 
-        })->UserId + 1;
+    try {
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(directoryMutex);
+        std::vector<int> changed;
+        for (int userId : pending) {
+            auto row = directory.find(userId);
+            auto activity = loginActivity.find(userId);
+            if (row == directory.end() || activity == loginActivity.end()) continue;
+            UserDto current = WithActivityLocked(row->second);
+            if (current.AccessCount != row->second.AccessCount || current.UpdatedDate != row->second.UpdatedDate) {
+                row->second = std::move(current);
+                changed.push_back(userId);
+            }
+        }
+        if (!changed.empty()) {
+            PersistLocked(changed);
+        }
+        return true;
+    } catch (...) {
+        // The counters still hold the truth; try again on the next flush.
+        std::lock_guard<std::mutex> lock(dirtyMutex);
+        dirtyLogins.insert(pending.begin(), pending.end());
+        return false;
+    }
+}
+
+// Caller must hold directoryMutex exclusively. Starts counting a loaded or new
+// account from its stored AccessCount. An account already tracked keeps its
+// live count: Login changes it without the directory lock, so a row read
+// before then must not roll it back. Only ResetFailedLogins clears it.
+void Users::TrackLoginLocked(const UserDto& user) {
+    auto& activity = loginActivity[user.UserId];
+    if (activity) return;
+    activity = std::make_shared<LoginActivity>();
+    activity->failedAttempts = user.AccessCount;
+}
+
+// Caller must hold directoryMutex.
+UserDto Users::WithActivityLocked(const UserDto& user) const {
+    UserDto current = user;
+    auto activity = loginActivity.find(user.UserId);
+    if (activity != loginActivity.end()) {
+        current.AccessCount = activity->second->failedAttempts;
+        current.UpdatedDate = std::max(current.UpdatedDate, activity->second->lastLogin.load());
+    }
+    return current;
 }
 
-bool Users::AddUser(UserDto user) {
+int Users::GetNextUserId() const {
+    return idSequence->Next();
+}
+
+std::string Users::AddUser(UserDto user) {
     try {
-        if (EmailExists(user.Email)) return false;
+        // Hashed before taking any lock; a slow hash must not hold up other writers.
+        auto hashed = AuthPool::Shared().Hash(user.Email, user.PasswordHash);
+        if (!hashed) {
+            return ServerBusy;
+        }
+        user.PasswordHash = std::move(*hashed);
         
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(directoryMutex);
         
-        flock(fd, LOCK_EX);
+        // Checked under the same lock as the insert, so two sign-ups with one
+        // address cannot both succeed.
+        std::string key = NormalizeEmail(user.Email);
+        if (byEmail.count(key) != 0) {
+            return "Email already exists";
+        }
         
-        auto users = LoadFromFile();
         user.UserId = GetNextUserId();
         user.CreatedDate = std::time(nullptr);
         user.UpdatedDate = std::time(nullptr);
-        user.PasswordHash = Utils::CreateSaltedHash(user.Email, user.PasswordHash);
         user.AccessCount = 0;
-        users.push_back(user);
-        SaveToFile(users);
+        directory[user.UserId] = user;
+        try {
+            PersistLocked(user.UserId);
+        } catch (...) {
+            directory.erase(user.UserId);
+            return "Unable to access database";
+        }
+        byEmail[key] = user.UserId;
+        TrackLoginLocked(user);
         
-        flock(fd, LOCK_UN);
-        close(fd);
-        return true;
+        return "success";
     } catch (...) {
-        return false;
+        return "Failed to add user";
     }
 }
 
 std::vector<UserDto> Users::GetAllUsers() {
-    int fd = open(filename.c_str(), O_RDONLY);
-    if (fd == -1) return {};
-    
-    flock(fd, LOCK_SH);
-    auto users = LoadFromFile();
-    flock(fd, LOCK_UN);
-    close(fd);
+    std::shared_lock<std::shared_mutex> lock(directoryMutex);
+    std::vector<UserDto> users;
+    users.reserve(directory.size());
+    for (const auto& entry : directory) {
+        users.push_back(WithActivityLocked(entry.second));
+    }
+    return users;
+}
+
+std::vector<UserDto> Users::GetUsersPage(int afterId, size_t limit) {
+    std::shared_lock<std::shared_mutex> lock(directoryMutex);
+    std::vector<UserDto> users;
+    for (auto it = directory.upper_bound(afterId); it != directory.end() && users.size() < limit; ++it) {
+        users.push_back(WithActivityLocked(it->second));
+    }
     return users;
 }
 
 UserDto Users::GetUserById(int id) {
-    auto users = GetAllUsers();
-    auto it = std::find_if(users.begin(), users.end(),
-        [id](const UserDto& user) { return user.UserId == id; });
-    return it != users.end() ? *it : UserDto{};
+    std::shared_lock<std::shared_mutex> lock(directoryMutex);
+    auto it = directory.find(id);
+    return it != directory.end() ? WithActivityLocked(it->second) : UserDto{};
+}
+
+std::unordered_map<int, UserDto> Users::GetUsersByIds(const std::vector<int>& ids) {
+    std::shared_lock<std::shared_mutex> lock(directoryMutex);
+    std::unordered_map<int, UserDto> users;
+    users.reserve(ids.size());
+    for (int id : ids) {
+        if (users.count(id)) continue;
+        auto it = directory.find(id);
+        if (it != directory.end()) {
+            users.emplace(id, WithActivityLocked(it->second));
+        }
+    }
+    return users;
 }
 
 UserDto Users::GetUserByEmail(const std::string& email) {
-    auto users = GetAllUsers();
-    auto it = std::find_if(users.begin(), users.end(),
-        [&email](const UserDto& user) { return user.Email == email; });
-    return it != users.end() ? *it : UserDto{};
+    std::shared_lock<std::shared_mutex> lock(directoryMutex);
+    const UserDto* user = FindByEmailLocked(email);
+    return user != nullptr ? WithActivityLocked(*user) : UserDto{};
 }
 
 std::vector<UserDto> Users::GetUsersByStatus(UserStatus status) {
+    std::shared_lock<std::shared_mutex> lock(directoryMutex);
     std::vector<UserDto> result;
-    auto users = GetAllUsers();
-    std::copy_if(users.begin(), users.end(), std::back_inserter(result),
-        [status](const UserDto& user) { return user.Status == status; });
+    for (const auto& entry : directory) {
+        if (entry.second.Status == status) {
+            result.push_back(WithActivityLocked(entry.second));
+        }
+    }
     return result;
 }
 
 bool Users::UpdateUser(const UserDto& user) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
-        
-        flock(fd, LOCK_EX);
-        auto users = LoadFromFile();
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(directoryMutex);
         
-        auto it = std::find_if(users.begin(), users.end(),
-            [&user](const UserDto& u) { return u.UserId == user.UserId; });
+        auto it = directory.find(user.UserId);
+        if (it != directory.end()) {
+            std::string oldKey = NormalizeEmail(it->second.Email);
+            std::string newKey = NormalizeEmail(user.Email);
+            auto owner = byEmail.find(newKey);
+            if (owner != byEmail.end() && owner->second != user.UserId) {
+                return false;  // the new address belongs to another account
+            }
             
-        if (it != users.end()) {
-            UserDto updatedUser = user;
-            updatedUser.UpdatedDate = std::time(nullptr);
-            *it = updatedUser;
-            SaveToFile(users);
+            UserDto previous = it->second;
+            it->second = user;
+            it->second.UpdatedDate = std::time(nullptr);
+            TrackLoginLocked(it->second);
+            it->second.AccessCount = loginActivity.at(user.UserId)->failedAttempts;
+            if (!SaveOrRestore(user.UserId, previous)) {
+                return false;
+            }
+            if (newKey != oldKey) {
+                byEmail.erase(oldKey);
+                byEmail[newKey] = user.UserId;
+            }
         }
         
-        flock(fd, LOCK_UN);
-        close(fd);
         return true;
     } catch (...) {
         return false;
@@ -213,17 +430,19 @@ bool Users::UpdateUserStatus(int userId, UserStatus newStatus, const std::string
     }
 }
 
-bool Users::UpdatePassword(int userId, const std::string& newPassword) {
+std::string Users::UpdatePassword(int userId, const std::string& newPassword) {
     try {
         auto user = GetUserById(userId);
-        if (user.UserId == 0) return false;
+        if (user.UserId == 0) return "User not found";
         
-        user.PasswordHash = Utils::CreateSaltedHash(user.Email, newPassword);
+        auto hashed = AuthPool::Shared().Hash(user.Email, newPassword);
+        if (!hashed) return ServerBusy;
+        user.PasswordHash = std::move(*hashed);
         user.UpdatedDate = std::time(nullptr);
         
-        return UpdateUser(user);
+        return UpdateUser(user) ? "success" : "Unable to access database";
     } catch (...) {
-        return false;
+        return "Failed to change password";
     }
 }
 
@@ -231,139 +450,148 @@ bool Users::SoftDeleteUser(int userId, const std::string& deletedBy) {
     return UpdateUserStatus(userId, UserStatus::UserStatus_DELETED, deletedBy);
 }
 
-bool Users::HardDeleteUser(int userId) {
+bool Users::ResetFailedLogins(int userId) {
     try {
-        int fd = open(filename.c_str(), O_RDWR);
-        if (fd == -1) return false;
-        
-        flock(fd, LOCK_EX);
-        auto users = LoadFromFile();
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(directoryMutex);
         
-        auto it = std::remove_if(users.begin(), users.end(),
-            [userId](const UserDto& user) { return user.UserId == userId; });
+        auto it = directory.find(userId);
+        auto activity = loginActivity.find(userId);
+        if (it == directory.end() || activity == loginActivity.end()) return false;
         
-        if (it != users.end()) {
-            users.erase(it, users.end());
-            SaveToFile(users);
+        UserDto previous = it->second;
+        int failures = activity->second->failedAttempts.exchange(0);
+        it->second.AccessCount = 0;
+        it->second.UpdatedDate = std::time(nullptr);
+        if (!SaveOrRestore(userId, previous)) {
+            activity->second->failedAttempts += failures;
+            return false;
         }
-        
-        flock(fd, LOCK_UN);
-        close(fd);
         return true;
     } catch (...) {
         return false;
     }
 }
 
-bool Users::AddBorrowedBook(int userId, const std::string& bookId) {
+bool Users::HardDeleteUser(int userId) {
     try {
-        auto user = GetUserById(userId);
-        if (user.UserId == 0) return false;
+        StoreFile::Lock fileLock(*storeFile);
+        std::unique_lock<std::shared_mutex> lock(directoryMutex);
         
-        user.BorrowedBooks.push_back(bookId);
-        user.UpdatedDate = std::time(nullptr);
+        auto it = directory.find(userId);
+        if (it != directory.end()) {
+            UserDto removed = std::move(it->second);
+            directory.erase(it);
+            try {
+                PersistLocked(userId);
+            } catch (...) {
+                directory[userId] = std::move(removed);
+                return false;
+            }
+            auto key = byEmail.find(NormalizeEmail(removed.Email));
+            if (key != byEmail.end() && key->second == userId) {
+                byEmail.erase(key);
+            }
+            loginActivity.erase(userId);
+        }
         
-        return UpdateUser(user);
+        return true;
     } catch (...) {
         return false;
     }
 }
 
-bool Users::AddReturnedBook(int userId, const std::string& bookId) {
+// Caller must hold directoryMutex exclusively with the change already applied
+// to directory. Puts `previous` back if the file cannot be written.
+bool Users::SaveOrRestore(int userId, const UserDto& previous) {
     try {
-        auto user = GetUserById(userId);
-        if (user.UserId == 0) return false;
-        
-        auto it = std::find(user.BorrowedBooks.begin(), user.BorrowedBooks.end(), bookId);
-        if (it != user.BorrowedBooks.end()) {
-            user.BorrowedBooks.erase(it);
-            user.ReturnedBooks.push_back(bookId);
-            user.UpdatedDate = std::time(nullptr);
-            return UpdateUser(user);
-        }
-        return false;
+        PersistLocked(userId);
+        return true;
     } catch (...) {
+        directory[userId] = previous;
         return false;
     }
 }
 
-std::vector<std::string> Users::GetBorrowedBooks(int userId) {
-    auto user = GetUserById(userId);
-    return user.UserId != 0 ? user.BorrowedBooks : std::vector<std::string>{};
+// Caller must hold directoryMutex exclusively with the change already applied
+// to directory. Throws if the change could not be made durable.
+void Users::PersistLocked(int userId) {
+    PersistLocked(std::vector<int>{userId});
 }
 
-std::vector<std::string> Users::GetReturnedBooks(int userId) {
-    auto user = GetUserById(userId);
-    return user.UserId != 0 ? user.ReturnedBooks : std::vector<std::string>{};
+void Users::PersistLocked(const std::vector<int>& userIds) {
+    if (journal == nullptr) {
+        SaveToFile();
+        return;
+    }
+    JournalRecord record;
+    for (int userId : userIds) {
+        auto it = directory.find(userId);
+        if (it != directory.end()) {
+            record.users.push_back(EncodeRow(it->second));
+        } else {
+            record.removedUsers.push_back(userId);
+        }
+    }
+    if (!journal->Append(record)) {
+        throw std::runtime_error("Failed to write journal");
+    }
 }
 
-void Users::SaveToFile(const std::vector<UserDto>& users) const {
-    json j = json::array();
-    for (const auto& user : users) {
-        json userJson;
-        userJson["UserId"] = user.UserId;
-        userJson["FirstName"] = user.FirstName;
-        userJson["LastName"] = user.LastName;
-        userJson["PasswordHash"] = user.PasswordHash;
-        userJson["Email"] = user.Email;
-        userJson["Type"] = static_cast<int>(user.Type);
-        userJson["Status"] = static_cast<int>(user.Status);
-        userJson["CreatedBy"] = user.CreatedBy;
-        userJson["CreatedDate"] = user.CreatedDate;
-        userJson["UpdatedBy"] = user.UpdatedBy;
-        userJson["UpdatedDate"] = user.UpdatedDate;
-        userJson["Address"] = user.Address;
-        userJson["PhoneNumber"] = user.PhoneNumber;
-        userJson["BorrowedBooks"] = user.BorrowedBooks;
-        userJson["ReturnedBooks"] = user.ReturnedBooks;
-        userJson["AccessCount"] = user.AccessCount;
-        j.push_back(userJson);
+// Caller must hold directoryMutex exclusively.
+void Users::InstallLocked(const UserDto& user) {
+    auto it = directory.find(user.UserId);
+    if (it != directory.end()) {
+        auto key = byEmail.find(NormalizeEmail(it->second.Email));
+        if (key != byEmail.end() && key->second == user.UserId) {
+            byEmail.erase(key);
+        }
     }
-    
-    std::ofstream file(filename);
-    file << std::setw(4) << j << std::endl;
+    TrackLoginLocked(user);
+    UserDto& row = directory[user.UserId] = user;
+    row.AccessCount = loginActivity.at(user.UserId)->failedAttempts;
+    byEmail.emplace(NormalizeEmail(user.Email), user.UserId);
+    idSequence->EnsureAtLeast(user.UserId + 1);
 }
 
-std::vector<UserDto> Users::LoadFromFile() const {
-    std::vector<UserDto> users;
-    std::ifstream file(filename);
-    if (!file.is_open()) return users;
-    
-    json j;
-    file >> j;
-    
-    for (const auto& userJson : j) {
-        UserDto user;
-        user.UserId = userJson["UserId"];
-        user.FirstName = userJson["FirstName"];
-        user.LastName = userJson["LastName"];
-        user.PasswordHash = userJson["PasswordHash"];
-        user.Email = userJson["Email"];
-        user.Type = static_cast<UserType>(userJson["Type"]);
-        user.Status = static_cast<UserStatus>(userJson["Status"]);
-        user.CreatedBy = userJson["CreatedBy"];
-        user.CreatedDate = userJson["CreatedDate"];
-        user.UpdatedBy = userJson["UpdatedBy"];
-        user.UpdatedDate = userJson["UpdatedDate"];
-        user.Address = userJson["Address"];
-        user.PhoneNumber = userJson["PhoneNumber"];
-        user.BorrowedBooks = userJson["BorrowedBooks"].get<std::vector<std::string>>();
-        user.ReturnedBooks = userJson["ReturnedBooks"].get<std::vector<std::string>>();
-        user.AccessCount = userJson.value("AccessCount", 0);
-        users.push_back(user);
+// Caller must hold directoryMutex exclusively. Journal replay runs before
+// any sign-in, so the replayed row's count is the account's count.
+void Users::RestoreLocked(const UserDto& user) {
+    TrackLoginLocked(user);
+    loginActivity.at(user.UserId)->failedAttempts = user.AccessCount;
+    InstallLocked(user);
+}
+
+// Caller must hold directoryMutex exclusively.
+void Users::EraseRowLocked(int userId) {
+    auto it = directory.find(userId);
+    if (it == directory.end()) return;
+    auto key = byEmail.find(NormalizeEmail(it->second.Email));
+    if (key != byEmail.end() && key->second == userId) {
+        byEmail.erase(key);
     }
-    
-    return users;
+    directory.erase(it);
+    loginActivity.erase(userId);
+}
+
+std::string Users::EncodeRow(const UserDto& user) {
+    return UserToJson(user).dump();
+}
+
+bool Users::DecodeRow(const std::string& row, UserDto& user) {
+    return Utils::ParseJsonRecord<UserDecoder>(row, user);
 }
 
-bool Users::UserExists(int userId) const {
-    auto users = LoadFromFile();
-    return std::any_of(users.begin(), users.end(),
-        [userId](const UserDto& user) { return user.UserId == userId; });
+// Caller must hold directoryMutex and a StoreFile::Lock.
+void Users::SaveToFile() const {
+    json j = json::array();
+    for (const auto& entry : directory) {
+        j.push_back(UserToJson(entry.second));
+    }
+    
+    storeFile->Replace(j.dump(4) + "\n");
 }
 
-bool Users::EmailExists(const std::string& email) const {
-    auto users = LoadFromFile();
-    return std::any_of(users.begin(), users.end(),
-        [&email](const UserDto& user) { return user.Email == email; });
-}
\ No newline at end of file
+std::vector<UserDto> Users::LoadFromFile() const {
+    return Utils::ParseJsonRecords<UserDecoder>(storeFile->Read());
+}
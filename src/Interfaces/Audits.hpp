@@ -2,8 +2,16 @@
 #define AUDITS_HPP
 
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <functional>
+#include <condition_variable>
 #include "Common.hpp"
 
+class IdSequence;
+
 struct AuditLogDto
 {
     int AuditLogId;
@@ -14,22 +22,63 @@ struct AuditLogDto
     std::time_t DateCreated;
 };
 
+// When the active audit segment is sealed and a new one started. A zero
+// limit disables that trigger.
+struct AuditRotationPolicy
+{
+    size_t maxSegmentBytes = 8 * 1024 * 1024;
+    std::time_t maxSegmentAgeSeconds = 24 * 60 * 60;
+    bool compressRotated = true;  // gzip sealed segments
+};
+
+// Append-only audit trail stored as JSON Lines. Records go to the active
+// segment (filename); sealed segments sit next to it as filename.000001,
+// filename.000002, ... optionally gzipped, and are read back in that order.
+// Rotation only renames the segment; a background thread gzips it afterwards.
 class Audits
 {
 private:
     std::string filename;
-    std::vector<AuditLogDto> LoadFromFile() const;
-    void SaveToFile(const std::vector<AuditLogDto>& auditLogs) const;
+    AuditRotationPolicy rotation;
+    std::shared_ptr<IdSequence> idSequence;
+    std::mutex writeMutex;
+    int appendFd;
+    std::time_t segmentStarted;  // DateCreated of the active segment's first record, 0 when empty
+
+    // Sealed segments still waiting to be gzipped, oldest first. The front
+    // one stays queued until its compression finishes.
+    std::deque<std::string> pendingCompression;
+    std::mutex compressMutex;
+    std::condition_variable compressSignal;
+    bool compressRunning;
+    std::thread compressThread;
+
     int GetNextAuditLogId() const;
+    void InitIdSequence();
+    void MigrateLegacyArray(const std::string& source);
+    void OpenActiveSegment();
+    void RotateIfNeeded(std::time_t now);
+    std::vector<std::string> SealedSegments() const;
+    int LastSegmentNumber() const;
+    void StartCompression();
+    void QueueCompression(const std::string& sealed);
+    void CompressLoop();
 
 public:
     Audits();
-    Audits(const std::string &filename);
+    Audits(const std::string &filename, const AuditRotationPolicy& policy = AuditRotationPolicy());
     ~Audits();
 
     bool AddAuditLog(AuditLogDto auditLog);
+    bool AddAuditLogs(std::vector<AuditLogDto> auditLogs);
+
+    // Streams every record, oldest segment first, until visitor returns false.
+    bool ForEachAuditLog(const std::function<bool(const AuditLogDto&)>& visitor) const;
     std::vector<AuditLogDto> GetAllAuditLogs();
 
+    // Blocks until every segment sealed so far has been compressed.
+    void WaitForCompression();
+
 };
 
-#endif
\ No newline at end of file
+#endif
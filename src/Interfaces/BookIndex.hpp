@@ -0,0 +1,61 @@
+#ifndef BOOK_INDEX_HPP
+#define BOOK_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// Search-ready view of a book: text fields are pre-lowercased and phonetic
+// codes and bigram signatures precomputed so queries never touch the raw
+// catalog strings.
+struct IndexedBook
+{
+    int BookId;
+    std::string Name;
+    std::string Author;
+    std::string Publisher;
+    std::string Isbn;  // kept verbatim, ISBN matching is case-sensitive
+    std::string NameSoundex;
+    std::string AuthorSoundex;
+    std::vector<uint16_t> NameBigrams;
+    std::vector<uint16_t> AuthorBigrams;
+    std::vector<uint16_t> PublisherBigrams;
+};
+
+// Inverted index over the catalog used to narrow a search down to the books
+// that can score at all: whole-token postings, bigram postings over
+// name/author/publisher, 2/3-gram postings over the ISBN and Soundex buckets
+// for name and author. Removal is lazy; postings are compacted once stale
+// entries outnumber live ones.
+class BookIndex
+{
+public:
+    BookIndex();
+
+    void Add(const IndexedBook& book);
+    void Remove(int bookId);
+    void Clear();
+    const IndexedBook* Find(int bookId) const;
+    size_t Size() const;
+
+    // Sorted, de-duplicated ids of every book sharing a token, bigram, ISBN
+    // gram or Soundex code with any query token.
+    std::vector<int> FindCandidates(const std::vector<std::string>& tokens,
+                                    const std::vector<std::string>& tokenSoundex) const;
+
+private:
+    using Postings = std::unordered_map<std::string, std::vector<int>>;
+
+    std::unordered_map<int, IndexedBook> entries;
+    Postings tokenPostings;
+    std::vector<std::vector<int>> bigramPostings;  // indexed by packed bigram
+    Postings isbnGramPostings;
+    Postings soundexBuckets;
+    size_t staleEntries;
+
+    void AddPostings(const IndexedBook& book);
+    void Rebuild();
+};
+
+#endif
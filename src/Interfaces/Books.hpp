@@ -9,9 +9,20 @@
 #include <set>
 #include <cctype>
 #include <sstream>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <array>
 
 #include "Common.hpp"
 #include "Categories.hpp"
+#include "BookIndex.hpp"
+
+class IdSequence;
+class StoreFile;
+class LibraryJournal;
 
 using BooksDto = struct BooksDto
 {
@@ -24,7 +35,7 @@ using BooksDto = struct BooksDto
 	std::time_t DateCreated;
 	std::time_t DateUpdated;
 	BookStatus Status;
-    std::vector<CategoryDto> Categories;
+    std::vector<int> CategoryIds;  // resolved against Categories when read
 };
 
 class Books
@@ -38,8 +49,17 @@ public:
 	bool AddBookCopies(int bookId, int copies);
 	bool RemoveBook(int bookId);
 	bool RemoveBookCopies(int bookId, int copies);
+	// Takes one copy if any are left, atomically; false when the book is
+	// missing or out of stock. ReleaseCopy puts one back.
+	bool TryReserveCopy(int bookId);
+	bool ReleaseCopy(int bookId);
 	std::vector<BooksDto> GetAllBooks();
 	BooksDto GetBooksById(int id);
+	std::vector<BooksDto> GetBooksByCategory(int categoryId);
+	// Resolves many ids under one lock; missing ids are left out of the map.
+	std::unordered_map<int, BooksDto> GetBooksByIds(const std::vector<int>& ids);
+	// Drops the category from every book that references it, in one write.
+	bool DetachCategory(int categoryId);
 
     struct SearchResult {
         BooksDto book;
@@ -49,17 +69,58 @@ public:
             return score > other.score;
         }
     };
-    std::vector<SearchResult> SearchBooks(const std::string& query, size_t limit = 10) const;
+    // Where a previous page of results ended; the next page starts after it.
+    struct SearchPosition {
+        double score;
+        int bookId;
+    };
+    std::vector<SearchResult> SearchBooks(const std::string& query, size_t limit = 10,
+                                          const SearchPosition* after = nullptr) const;
 
 private:
+    // A query prepared once per search: tokens plus their phonetic codes and
+    // bigram signatures.
+    struct SearchQuery {
+        std::vector<std::string> Tokens;
+        std::vector<std::string> Soundex;
+        std::vector<std::vector<uint16_t>> Bigrams;
+    };
+
 	std::string filename;
-	void SaveToFile(const std::vector<BooksDto>& books) const;
+    // Resident catalog, loaded once and authoritative for all reads.
+    std::map<int, BooksDto> catalog;
+    mutable std::shared_mutex catalogMutex;
+    // A row's copy count may change under a shared catalogMutex plus that row's
+    // stripe; every other change needs catalogMutex exclusively.
+    static constexpr size_t RowLockStripes = 64;
+    mutable std::array<std::mutex, RowLockStripes> rowLocks;
+    std::shared_ptr<IdSequence> idSequence;
+    std::shared_ptr<StoreFile> storeFile;
+    BookIndex searchIndex;
+    // Category id -> ids of the books filed under it, each list sorted.
+    std::unordered_map<int, std::vector<int>> booksByCategory;
+    LibraryJournal* journal = nullptr;  // set while a LibraryJournal is attached
+    friend class LibraryJournal;
+    void LoadCatalog();
+    size_t RowStripe(int bookId) const;
+    BooksDto CopyRowLocked(const BooksDto& book) const;
+    void ApplyCopiesLocked(const BooksDto& book);
+    bool AdjustCopies(int bookId, int delta);
+    void PersistLocked(int bookId);
+    void PersistLocked(const std::vector<int>& bookIds);
+    void IndexCategoriesLocked(const BooksDto& book);
+    void UnindexCategoriesLocked(const BooksDto& book);
+    void InstallLocked(const BooksDto& book);
+    void EraseRowLocked(int bookId);
+    static std::string EncodeRow(const BooksDto& book);
+    static bool DecodeRow(const std::string& row, BooksDto& book);
+	void SaveToFile() const;
 	std::vector<BooksDto> LoadFromFile() const;
     int GetNextBookId() const;
-    double CalculateNGramSimilarity(const std::string& s1, const std::string& s2, int n = 2) const;
     std::string GetSoundex(const std::string& word) const;
     std::vector<std::string> Tokenize(const std::string& text) const;
-    double CalculateSearchScore(const BooksDto& book, const std::string& query) const;
+    IndexedBook MakeIndexEntry(const BooksDto& book) const;
+    double CalculateSearchScore(const IndexedBook& book, const SearchQuery& query) const;
 };
 
 #endif
\ No newline at end of file
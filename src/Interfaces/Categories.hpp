@@ -3,9 +3,16 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <map>
+#include <shared_mutex>
 
 #include "Common.hpp"
 
+class IdSequence;
+class Books;
+class StoreFile;
+
 using categoryDto = struct CategoryDto
 {
     int CategoryId;
@@ -22,13 +29,25 @@ public:
     ~Categories();
 
     bool AddCategory(CategoryDto category);
-    bool RemoveCategory(int categoryId);
+    // Detaches the category from every book first, so no book is left
+    // pointing at a category that no longer exists.
+    bool RemoveCategory(int categoryId, Books& books);
     std::vector<CategoryDto> GetAllCategories();
     CategoryDto GetCategoryById(int id);
+    // Joins a book's CategoryIds to their rows; unknown ids are skipped.
+    std::vector<CategoryDto> GetCategoriesByIds(const std::vector<int>& categoryIds);
 
 private:
     std::string filename;
-    void SaveToFile(const std::vector<CategoryDto>& categories) const;
+    // Resident table, loaded once and authoritative for all reads.
+    std::map<int, CategoryDto> table;
+    mutable std::shared_mutex tableMutex;
+    std::shared_ptr<IdSequence> idSequence;
+    std::shared_ptr<StoreFile> storeFile;
+    // Drops the row alone; only reachable through the detaching overload.
+    bool RemoveCategory(int categoryId);
+    void LoadTable();
+    void SaveToFile() const;
     std::vector<CategoryDto> LoadFromFile() const;
     int GetNextCategoryId() const;
 };
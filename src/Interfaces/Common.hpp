@@ -33,6 +33,12 @@ enum UserStatus : int
 	UserStatus_DELETED
 };
 
+enum class StorageMode {
+    SNAPSHOT,
+    WRITE_AHEAD_LOG,
+    BINARY
+};
+
 enum class SessionState {
     INITIAL,
     LOGIN_EMAIL,
@@ -79,7 +85,8 @@ enum class UserCommand {
     VIEW_ALL_TRANSACTIONS = 17,
     HARD_DELETE_USER = 18,
     HARD_DELETE_USER_CONFIRMED = 19,
-    CHANGE_PASSWORD = 20
+    CHANGE_PASSWORD = 20,
+    VIEW_AUTH_METRICS = 21
 };
 
 enum class MenuType{
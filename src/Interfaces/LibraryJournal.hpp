@@ -0,0 +1,117 @@
+#ifndef LIBRARY_JOURNAL_HPP
+#define LIBRARY_JOURNAL_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "Books.hpp"
+#include "Users.hpp"
+#include "Transactions.hpp"
+
+class WriteAheadLog;
+
+// One committed change set: post-images of changed rows (each already encoded
+// as a JSON object) and the ids of removed rows.
+struct JournalRecord
+{
+    std::vector<std::string> books;
+    std::vector<std::string> users;
+    std::vector<std::string> transactions;
+    std::vector<int> removedBooks;
+    std::vector<int> removedUsers;
+    std::vector<int> removedTransactions;
+
+    bool Empty() const;
+    std::string Encode() const;
+};
+
+// Changes to Books, Users and Transactions staged together and committed as a
+// single journal record. Each change runs at commit time against the row as
+// committed, with all three stores locked; a change returning false (or a
+// missing row) aborts the whole unit and nothing is written.
+class UnitOfWork
+{
+public:
+    using BookChange = std::function<bool(BooksDto&)>;
+    using UserChange = std::function<bool(UserDto&)>;
+    using TransactionChange = std::function<bool(TransactionsDto&)>;
+
+    void UpdateBook(int bookId, BookChange change);
+    // Copy-count changes; a unit whose only book changes are these locks just
+    // the affected rows of the catalog.
+    void ReserveCopy(int bookId);
+    void ReleaseCopy(int bookId);
+    void UpdateUser(int userId, UserChange change);
+    // The transaction gets its id at commit; see AddedTransactionIds().
+    void AddTransaction(const TransactionsDto& transaction);
+    void UpdateTransaction(int transactionId, TransactionChange change);
+
+    const std::vector<int>& AddedTransactionIds() const { return addedIds; }
+    const std::string& Error() const { return error; }
+    bool OutOfStock() const { return outOfStock; }
+
+private:
+    friend class LibraryJournal;
+
+    std::vector<std::pair<int, BookChange>> bookChanges;
+    std::vector<std::pair<int, int>> copyChanges;
+    std::vector<std::pair<int, UserChange>> userChanges;
+    std::vector<TransactionsDto> addedTransactions;
+    std::vector<std::pair<int, TransactionChange>> transactionChanges;
+    std::vector<int> addedIds;
+    std::string error;
+    bool outOfStock = false;
+};
+
+// Redo log shared by Books, Users and Transactions. While attached, the stores
+// log changed rows here (one append and one fsync per commit) instead of
+// rewriting their files; Checkpoint() folds the journal into the store files
+// and empties it. On construction any records left by a previous run are
+// replayed on top of the store files.
+//
+// Once checkpointAfterRecords records are pending the journal checkpoints
+// itself: at the end of Commit, or on its checkpoint thread when the record
+// came from a single-store write whose caller still holds its store lock.
+class LibraryJournal
+{
+public:
+    LibraryJournal(const std::string& path, Books& books, Users& users, Transactions& transactions,
+                   size_t checkpointAfterRecords = 1000);
+    ~LibraryJournal();
+
+    LibraryJournal(const LibraryJournal&) = delete;
+    LibraryJournal& operator=(const LibraryJournal&) = delete;
+
+    // Applies every staged change or none of them. Returns false with
+    // work.Error() set when a change is rejected or the journal write fails.
+    bool Commit(UnitOfWork& work);
+
+    // Single-store writes; the caller holds that store's lock.
+    bool Append(const JournalRecord& record);
+
+    void Checkpoint();
+    size_t PendingRecords();
+
+private:
+    Books& books;
+    Users& users;
+    Transactions& transactions;
+    std::unique_ptr<WriteAheadLog> log;
+    size_t checkpointAfter;
+    std::mutex checkpointMutex;
+    std::condition_variable checkpointSignal;
+    bool checkpointWanted = false;
+    bool checkpointRunning = true;
+    std::thread checkpointThread;
+
+    void Replay();
+    void RequestCheckpoint();
+    void CheckpointLoop();
+};
+
+#endif
@@ -2,11 +2,16 @@
 #define LIBRARY_MANAGER_HPP
 
 #include <string>
-#include <unordered_map>
+#include <atomic>
+#include <chrono>
 #include "Common.hpp"
 #include "../Interfaces/Books.hpp"
 #include "../Interfaces/Users.hpp"
 #include "../Interfaces/Transactions.hpp"
+#include "../Interfaces/LibraryJournal.hpp"
+#include "../Utils/SessionStore.hpp"
+#include "../Utils/PageCursor.hpp"
+#include "../Utils/ResponseBuffer.hpp"
 
 struct Session {
     SessionState state{SessionState::INITIAL};
@@ -28,6 +33,8 @@ struct Session {
     std::string categoryName{};
     std::string categoryDescription{};
     MenuType currentMenu{MenuType::INITIAL};
+    std::string searchTerm{};  // resumed by "1 <cursor>"
+    size_t searchPageSize{Utils::DefaultPageSize};
 };
 
 class LibraryManager {
@@ -36,35 +43,40 @@ private:
     Categories categories;
     Users users;
     Transactions transactions;
+    LibraryJournal journal;  // must follow the stores it journals
     UserDto currentUser;
     bool isLoggedIn = false;
-    std::unordered_map<int, Session> sessions;
+    SessionStore<Session> sessions;
+    std::atomic<unsigned long> commandCount{0};
+    static constexpr unsigned long EvictionInterval = 1024;
+    static constexpr std::chrono::seconds SessionIdleTimeout{30 * 60};
     bool ValidatePassword(const std::string& password);
 
 public:
     LibraryManager();
-    std::string ProcessCommand(int clientId, const std::string& command);
-    std::string HandleLogin(int clientId, const std::string& input);
-    std::string HandleRegistration(int clientId, const std::string& input);
-    std::string HandleBookSearch(const std::string& searchTerm);
-    std::string HandleBorrowBook(int clientId, const std::string& bookId);
-    std::string HandleReturnBook(int clientId, const std::string& bookId);
-    std::string HandleAddBook(int clientId, const std::string& bookDetails);
-    std::string HandleRemoveBook(const std::string& bookId);
-    std::string HandleAddCategory(int clientId, const std::string& categoryName);
-    std::string ViewBorrowedBooks(int clientId);
-    std::string ViewReturnedBooks(int clientId);
-    std::string HandleManageUsers();
-    std::string HandleUserStatusChange(int clientId, const std::string& userId, UserStatus newStatus);
-    std::string HandleUserTypeChange(int clientId, const std::string& userId, UserType newType);
-    std::string HandleViewUserTransactions(int clientId, const std::string& userId);
-    std::string HandleHardDeleteUser(int clientId, const std::string& userId);
-    std::string HandleHardDeleteUserConfirmed(int clientId, const std::string& userId);
-    std::string HandleChangePassword(int clientId, const std::string& newPassword);
-    std::string HandleViewAllTransactions();
+    void ProcessCommand(int clientId, const std::string& command, ResponseBuffer& out);
+    void HandleLogin(Session& session, const std::string& input, ResponseBuffer& out);
+    void HandleRegistration(Session& session, const std::string& input, ResponseBuffer& out);
+    void HandleBookSearch(const std::string& searchTerm, const Utils::PageRequest& page, ResponseBuffer& out);
+    void HandleBorrowBook(Session& session, const std::string& bookId, ResponseBuffer& out);
+    void HandleReturnBook(Session& session, const std::string& bookId, ResponseBuffer& out);
+    void HandleAddBook(Session& session, const std::string& bookDetails, ResponseBuffer& out);
+    void HandleRemoveBook(const std::string& bookId, ResponseBuffer& out);
+    void HandleAddCategory(Session& session, const std::string& categoryName, ResponseBuffer& out);
+    void ViewBorrowedBooks(Session& session, const Utils::PageRequest& page, ResponseBuffer& out);
+    void ViewReturnedBooks(Session& session, const Utils::PageRequest& page, ResponseBuffer& out);
+    void HandleManageUsers(const Utils::PageRequest& page, ResponseBuffer& out);
+    void HandleUserStatusChange(Session& session, const std::string& userId, UserStatus newStatus, ResponseBuffer& out);
+    void HandleUserTypeChange(Session& session, const std::string& userId, UserType newType, ResponseBuffer& out);
+    void HandleViewUserTransactions(Session& session, const std::string& userId, ResponseBuffer& out);
+    void HandleHardDeleteUser(Session& session, const std::string& userId, ResponseBuffer& out);
+    void HandleHardDeleteUserConfirmed(Session& session, const std::string& userId, ResponseBuffer& out);
+    void HandleChangePassword(Session& session, const std::string& newPassword, ResponseBuffer& out);
+    void HandleViewAllTransactions(const Utils::PageRequest& page, ResponseBuffer& out);
+    void HandleViewAuthMetrics(ResponseBuffer& out);
     void ClearSession(int clientId);
-    std::string GetMainMenu(UserType type);
-    std::string GetCurrentMenu(const Session& session);
+    const std::string& GetMainMenu(UserType type);
+    const std::string& GetCurrentMenu(const Session& session);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef TRANSACTION_FILE_HPP
+#define TRANSACTION_FILE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+struct TransactionsDto;
+
+// On-disk layout of one transaction: fixed width, host byte order, no padding.
+// A TransactionId of 0 marks a free slot.
+#pragma pack(push, 1)
+struct TransactionRecord
+{
+    int32_t TransactionId;
+    int32_t UserId;
+    int32_t BookId;
+    int32_t Status;
+    int64_t CreatedDate;
+    int64_t BorrowDate;
+    int64_t DueDate;
+    int64_t ReturnDate;
+    int64_t ActualReturnDate;
+};
+
+struct TransactionFileHeader
+{
+    char Magic[8];        // "LIBTXN\0\0"
+    uint32_t Version;
+    uint32_t RecordSize;
+    uint32_t ByteOrder;   // 0x01020304 as written by the host that created the file
+    uint32_t Reserved;
+    uint64_t SlotCount;   // slots in use, live or free
+    uint8_t Padding[32];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(TransactionRecord) == 56, "TransactionRecord layout changed");
+static_assert(sizeof(TransactionFileHeader) == 64, "TransactionFileHeader layout changed");
+
+// Binary transaction store: a versioned header followed by an array of
+// TransactionRecord slots. The file is mapped read-only for lookups and
+// changed in place with pwrite at the record's offset; the file grows in
+// chunks so appends rarely need a new mapping.
+class TransactionFile
+{
+public:
+    static constexpr uint32_t CurrentVersion = 1;
+
+    explicit TransactionFile(const std::string& path);
+    ~TransactionFile();
+
+    TransactionFile(const TransactionFile&) = delete;
+    TransactionFile& operator=(const TransactionFile&) = delete;
+
+    size_t SlotCount() const;
+    bool IsLive(size_t slot) const;
+    TransactionsDto Read(size_t slot) const;
+    void Write(size_t slot, const TransactionsDto& transaction);
+    size_t Append(const TransactionsDto& transaction);
+    void Clear(size_t slot);
+    bool Sync();
+
+private:
+    std::string path;
+    int fd;
+    const uint8_t* mapping;
+    size_t mappedSize;
+    size_t slotCount;
+
+    const TransactionRecord& RecordAt(size_t slot) const;
+    void WriteAt(off_t offset, const void* data, size_t size);
+    void Reserve(size_t slots);
+    void Map(size_t size);
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef TRANSACTION_INDEX_HPP
+#define TRANSACTION_INDEX_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include <unordered_map>
+
+#include "Common.hpp"
+
+struct TransactionsDto;
+
+// Secondary indexes over the transaction ledger. Key lookups return the
+// matching transaction ids in ascending order, so callers see the same order
+// as a scan of the ledger. Date ranges come back sorted by date, then id.
+//
+// Postings whose key a transaction can change after it is written (its status,
+// and the patron's loans keyed by status) are ordered sets, so a return or a
+// renewal re-files in logarithmic time however large the ledger grows. Keys
+// fixed at borrow time (patron, book, dates) are sorted vectors: new ids only
+// ever append to them, and Update leaves them alone unless the key changed.
+// The ledger-wide date indexes are bucketed by day for the same reason.
+class TransactionIndex
+{
+public:
+    void Add(const TransactionsDto& transaction);
+    void Remove(const TransactionsDto& transaction);
+    // Re-files one transaction, touching only the postings whose key changed.
+    void Update(const TransactionsDto& previous, const TransactionsDto& current);
+    void Clear();
+
+    const std::vector<int>& ByUser(int userId) const;
+    const std::vector<int>& ByBook(int bookId) const;
+    const std::set<int>& ByStatus(BorrowStatus status) const;
+
+    // Lowest id with this (UserId, BookId, Status), or 0 when there is none.
+    int FindLoan(int userId, int bookId, BorrowStatus status) const;
+
+    // One patron's transactions in one status, at most `limit` of them with
+    // ids above afterId. Both are a seek into that status's own ids.
+    std::vector<int> ByUserAndStatus(int userId, BorrowStatus status, int afterId = 0,
+                                     size_t limit = SIZE_MAX) const;
+    size_t CountByUserAndStatus(int userId, BorrowStatus status) const;
+
+    // Ids whose BorrowDate/DueDate falls in [startDate, endDate].
+    std::vector<int> BorrowedBetween(std::time_t startDate, std::time_t endDate) const;
+    std::vector<int> DueBetween(std::time_t startDate, std::time_t endDate) const;
+    std::vector<int> BorrowedBetween(int userId, std::time_t startDate, std::time_t endDate) const;
+    std::vector<int> DueBetween(int userId, std::time_t startDate, std::time_t endDate) const;
+
+private:
+    struct LoanEntry
+    {
+        int BookId;
+        int Status;
+        int TransactionId;
+        bool operator<(const LoanEntry& other) const {
+            if (BookId != other.BookId) return BookId < other.BookId;
+            if (Status != other.Status) return Status < other.Status;
+            return TransactionId < other.TransactionId;
+        }
+    };
+
+    struct DatedId
+    {
+        std::time_t Date;
+        int TransactionId;
+        bool operator<(const DatedId& other) const {
+            return Date != other.Date ? Date < other.Date : TransactionId < other.TransactionId;
+        }
+        bool operator==(const DatedId& other) const {
+            return Date == other.Date && TransactionId == other.TransactionId;
+        }
+    };
+
+    using DateRun = std::vector<DatedId>;
+
+    // Everything keyed by patron, so a patron costs one hash entry.
+    struct UserEntries
+    {
+        std::vector<int> Ids;
+        std::set<LoanEntry> Loans;  // the composite (UserId, BookId, Status) key
+        std::map<int, std::set<int>> IdsByStatus;
+        DateRun BorrowDates;
+        DateRun DueDates;
+    };
+
+    std::unordered_map<int, UserEntries> byUser;
+    std::unordered_map<int, std::vector<int>> byBook;
+    std::unordered_map<int, std::set<int>> byStatus;
+    std::map<std::time_t, DateRun> borrowDays;  // keyed by day number
+    std::map<std::time_t, DateRun> dueDays;
+
+    static void AddDated(std::map<std::time_t, DateRun>& days, const DatedId& entry);
+    static void RemoveDated(std::map<std::time_t, DateRun>& days, const DatedId& entry);
+    static void CollectRange(const DateRun& run, std::time_t startDate, std::time_t endDate, std::vector<int>& ids);
+    static std::vector<int> Range(const std::map<std::time_t, DateRun>& days, std::time_t startDate, std::time_t endDate);
+};
+
+#endif
@@ -3,8 +3,22 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <optional>
+#include <atomic>
+#include <cstdint>
 
 #include "Common.hpp"
+#include "TransactionIndex.hpp"
+
+class WriteAheadLog;
+class IdSequence;
+class StoreFile;
+class TransactionFile;
+class LibraryJournal;
 
 using transactionsDto = struct TransactionsDto
 {
@@ -23,16 +37,21 @@ class Transactions
 {
     public:
         Transactions();
-        Transactions(const std::string& filename);
+        Transactions(const std::string& filename, StorageMode mode = StorageMode::SNAPSHOT);
         ~Transactions();
 
         std::string AddTransaction(TransactionsDto transaction);
         std::string UpdateTransaction(TransactionsDto transaction);
         std::string RemoveTransaction(int transactionId);
         std::vector<TransactionsDto> GetAllTransactions();
+        // Up to `limit` transactions with ids above afterId, in id order.
+        std::vector<TransactionsDto> GetTransactionsPage(int afterId, size_t limit);
         std::vector<TransactionsDto> GetTransactionsByUserId(int userId);
         TransactionsDto GetTransactionById(int transactionId);
         std::vector<TransactionsDto> GetTransactionsByStatus(BorrowStatus status);
+        std::vector<TransactionsDto> GetTransactionsByUserAndStatus(int userId, BorrowStatus status,
+                                                                    int afterId = 0, size_t limit = SIZE_MAX);
+        size_t CountTransactionsByUserAndStatus(int userId, BorrowStatus status);
         std::vector<TransactionsDto> GetTransactionsByBookId(const int& bookId);
         std::vector<TransactionsDto> GetTransactionsByDate(const std::time_t& startDate, const std::time_t& endDate);
         std::vector<TransactionsDto> GetTransactionsByDateAndUserId(const std::time_t& startDate, const std::time_t& endDate, const int& userId);
@@ -41,10 +60,57 @@ class Transactions
         TransactionsDto GetBorrowedTransactionsByUserAndBookId(const int& userId, const int& bookId);
         TransactionsDto GetReturnedTransactionsByUserAndBookId(const int& userId, const int& bookId);
 
+        // Folds the write-ahead log into a fresh snapshot and truncates it.
+        bool Compact();
+
+        // Converters between the JSON snapshot and the binary record file.
+        static bool ConvertJsonToBinary(const std::string& jsonFile, const std::string& binaryFile);
+        static bool ConvertBinaryToJson(const std::string& binaryFile, const std::string& jsonFile);
+
     private:
         std::string filename;
-        void SaveToFile(const std::vector<TransactionsDto>& transactions) const;
-        std::vector<TransactionsDto> LoadFromFile() const;
+        StorageMode mode;
+        std::map<int, TransactionsDto> ledger;          // SNAPSHOT and WRITE_AHEAD_LOG
+        std::unique_ptr<TransactionFile> records;       // BINARY: rows stay in the mapped file
+        std::vector<uint32_t> slotOf;                   // BINARY: dense TransactionId -> record slot
+        std::vector<size_t> freeSlots;
+        size_t liveRecords = 0;
+        static constexpr uint32_t NoSlot = UINT32_MAX;
+        // Built on the first indexed query rather than at open, so opening a
+        // large ledger costs only the scan for its ids. Until then writes
+        // leave the index alone; the build reads whatever the ledger holds.
+        TransactionIndex index;
+        std::atomic<bool> indexed{false};
+        std::mutex indexBuildMutex;
+        mutable std::shared_mutex ledgerMutex;
+        std::unique_ptr<WriteAheadLog> wal;
+        std::shared_ptr<IdSequence> idSequence;
+        std::shared_ptr<StoreFile> storeFile;
+        LibraryJournal* journal = nullptr;  // set while a LibraryJournal is attached
+        friend class LibraryJournal;
+        static constexpr size_t CompactAfterRecords = 10000;
+
+        void LoadLedger();
+        void LoadRecords();
+        std::optional<size_t> SlotLocked(int transactionId) const;
+        std::optional<TransactionsDto> FindLocked(int transactionId) const;
+        TransactionsDto ReadLocked(int transactionId) const;
+        const TransactionIndex& IndexLocked();
+        void PutLocked(const TransactionsDto& transaction);
+        void EraseLocked(int transactionId);
+        template <typename Ids>
+        std::vector<TransactionsDto> CollectLocked(const Ids& transactionIds) const;
+        void ReplayLog();
+        bool Persist(const TransactionsDto* changed, int removedId);
+        bool CompactLocked();
+        bool WriteSnapshotLocked();
+        bool CheckpointLocked();
+        void StampNew(TransactionsDto& transaction) const;
+        void InstallLocked(const TransactionsDto& transaction);
+        static std::string EncodeRow(const TransactionsDto& transaction);
+        static bool DecodeRow(const std::string& row, TransactionsDto& transaction);
+        void SaveToFile() const;
+        void LoadFromFile();
         int GetNextTransactionId() const;
 };
 
@@ -2,9 +2,23 @@
 #define USERS_HPP
 
 #include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <unordered_map>
 
 #include "Common.hpp"
 
+class IdSequence;
+class StoreFile;
+class LibraryJournal;
+
 using UserDto = struct UserDto
 {
     int UserId;
@@ -21,8 +35,6 @@ using UserDto = struct UserDto
     std::string Address;
     std::string PhoneNumber;
     int AccessCount;
-    std::vector<std::string> BorrowedBooks;
-    std::vector<std::string> ReturnedBooks;
 };
 
 class Users {
@@ -31,34 +43,85 @@ class Users {
         Users(const std::string& filename);
         ~Users();
 
-        
-        bool AddUser(UserDto user);
+        // Returned by AddUser, Login and UpdatePassword when the password
+        // hashing pool turns the request away.
+        static constexpr const char* ServerBusy = "Server busy. Please try again";
+
+        // "success", or the reason the account was not created.
+        std::string AddUser(UserDto user);
         std::string Login(const std::string& email, const std::string& password);
         
         std::vector<UserDto> GetAllUsers();
+        // Up to `limit` users with ids above afterId, in id order.
+        std::vector<UserDto> GetUsersPage(int afterId, size_t limit);
         UserDto GetUserById(int id);
         UserDto GetUserByEmail(const std::string& email);
+        // Resolves many ids under one lock; missing ids are left out of the map.
+        std::unordered_map<int, UserDto> GetUsersByIds(const std::vector<int>& ids);
         std::vector<UserDto> GetUsersByStatus(UserStatus status);
         
         bool UpdateUser(const UserDto& user);
         bool UpdateUserStatus(int userId, UserStatus newStatus, const std::string& updatedBy);
-        bool UpdatePassword(int userId, const std::string& newPasswordHash);
+        // "success", or the reason the password was not changed.
+        std::string UpdatePassword(int userId, const std::string& newPasswordHash);
           
         bool SoftDeleteUser(int userId, const std::string& deletedBy);
         bool HardDeleteUser(int userId);
+        // Clears the failed sign-in count, unlocking the account. Other
+        // updates never change the count, whatever AccessCount they carry.
+        bool ResetFailedLogins(int userId);
+
+        // Writes pending failed-attempt counts and sign-in times to the store
+        // now rather than at the next background flush.
+        bool FlushLoginActivity();
         
-        bool AddBorrowedBook(int userId, const std::string& bookId);
-        bool AddReturnedBook(int userId, const std::string& bookId);
-        std::vector<std::string> GetBorrowedBooks(int userId);
-        std::vector<std::string> GetReturnedBooks(int userId);
 
     private:
         std::string filename;
-        void SaveToFile(const std::vector<UserDto>& users) const;
+        // Resident directory, loaded once and authoritative for all reads.
+        std::map<int, UserDto> directory;
+        std::unordered_map<std::string, int> byEmail;  // normalized email -> UserId
+        mutable std::shared_mutex directoryMutex;
+        std::shared_ptr<IdSequence> idSequence;
+        std::shared_ptr<StoreFile> storeFile;
+        LibraryJournal* journal = nullptr;  // set while a LibraryJournal is attached
+        friend class LibraryJournal;
+
+        // Sign-in state, updated without the directory lock. The counters are
+        // authoritative (reads overlay them on the row) and are folded into
+        // AccessCount/UpdatedDate by a background flush, in batches.
+        struct LoginActivity {
+            std::atomic<int> failedAttempts{0};
+            std::atomic<std::time_t> lastLogin{0};
+        };
+        std::unordered_map<int, std::shared_ptr<LoginActivity>> loginActivity;  // guarded by directoryMutex
+        std::mutex dirtyMutex;
+        std::set<int> dirtyLogins;
+        std::condition_variable flushSignal;
+        bool flushRunning = true;
+        std::thread flushThread;
+        static constexpr int MaxFailedLogins = 5;
+        static constexpr std::chrono::milliseconds LoginFlushInterval{1000};
+        static constexpr size_t LoginFlushBatch = 256;
+
+        void FlushLoop();
+        void MarkLoginDirty(int userId);
+        void TrackLoginLocked(const UserDto& user);
+        UserDto WithActivityLocked(const UserDto& user) const;
+        void LoadDirectory();
+        UserDto* FindByEmailLocked(const std::string& email);
+        bool SaveOrRestore(int userId, const UserDto& previous);
+        void PersistLocked(int userId);
+        void PersistLocked(const std::vector<int>& userIds);
+        void InstallLocked(const UserDto& user);
+        void RestoreLocked(const UserDto& user);
+        void EraseRowLocked(int userId);
+        static std::string EncodeRow(const UserDto& user);
+        static bool DecodeRow(const std::string& row, UserDto& user);
+        void SaveToFile() const;
         std::vector<UserDto> LoadFromFile() const;
-        bool UserExists(int userId) const;
-        bool EmailExists(const std::string& email) const;
         int GetNextUserId() const;
+        static std::string NormalizeEmail(const std::string& email);
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <unistd.h>
+#include <cerrno>
 
 LibraryClient::LibraryClient(const std::string& serverIp, int port) {
     clientSocket = socket(AF_INET, SOCK_STREAM, 0);
@@ -15,6 +16,7 @@ LibraryClient::LibraryClient(const std::string& serverIp, int port) {
     serverAddr.sin_port = htons(port);
     
     if (connect(clientSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+        close(clientSocket);
         throw std::runtime_error("Failed to connect to server");
     }
     
@@ -29,18 +31,49 @@ bool LibraryClient::ConnectToServer() {
     return connected;
 }
 
+bool LibraryClient::SendAll(const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t bytesSent = send(clientSocket, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (bytesSent < 0 && errno == EINTR) continue;
+        if (bytesSent <= 0) return false;
+        written += bytesSent;
+    }
+    return true;
+}
+
 bool LibraryClient::SendRequestToServer(const std::string& request) {
-    ssize_t bytesSent = send(clientSocket, request.c_str(), request.length(), 0);
-    return bytesSent == static_cast<ssize_t>(request.length());
+    return SendAll(Utils::EncodeFrame(request));
+}
+
+bool LibraryClient::SendRequestsToServer(const std::vector<std::string>& requests) {
+    std::string batch;
+    for (const auto& request : requests) {
+        Utils::AppendFrame(batch, request);
+    }
+    return SendAll(batch);
 }
 
 std::string LibraryClient::ReceiveData() {
-    char buffer[1024];
-    ssize_t bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-    if (bytesRead <= 0) return "";
-    
-    buffer[bytesRead] = '\0';
-    return std::string(buffer);
+    std::string response;
+    char buffer[16384];
+    while (!decoder.Next(response)) {
+        if (decoder.Failed()) return "";
+        ssize_t bytesRead = recv(clientSocket, buffer, sizeof(buffer), 0);
+        if (bytesRead < 0 && errno == EINTR) continue;
+        if (bytesRead <= 0) return "";
+        decoder.Feed(buffer, bytesRead);
+    }
+    return response;
+}
+
+std::vector<std::string> LibraryClient::ReceiveResponses(size_t count) {
+    std::vector<std::string> responses;
+    responses.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        responses.push_back(ReceiveData());
+    }
+    return responses;
 }
 
 void LibraryClient::CloseConnection() {
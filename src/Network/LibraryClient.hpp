@@ -2,22 +2,31 @@
 #define LIBRARY_CLIENT_HPP
 
 #include <string>
+#include <vector>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
+#include "../Utils/Framing.hpp"
+
 class LibraryClient {
 private:
     int clientSocket;
     bool connected;
-    
+    Utils::FrameDecoder decoder;
+
+    bool SendAll(const std::string& data);
+
 public:
     LibraryClient(const std::string& serverIp, int port);
     ~LibraryClient();
     bool ConnectToServer();
     bool SendRequestToServer(const std::string& request);
+    // Writes every request in a single round trip; replies arrive in order.
+    bool SendRequestsToServer(const std::vector<std::string>& requests);
     std::string ReceiveData();
+    std::vector<std::string> ReceiveResponses(size_t count);
     void CloseConnection();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,11 +1,19 @@
 #include "LibraryServer.hpp"
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <unistd.h>
+#include <cerrno>
 #include <iostream>
 
-LibraryServer::LibraryServer(int port) : auditLogger(audit) {
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+LibraryServer::LibraryServer(int port, const ServerConfig& serverConfig)
+    : config(serverConfig), running(false), auditLogger(audit) {
+    if (config.backlog < 1) config.backlog = 1;
+    if (config.ioThreads < 1) config.ioThreads = 1;
+    if (config.workerThreads < 1) config.workerThreads = 1;
+
+    serverSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (serverSocket < 0) {
         throw std::runtime_error("Failed to create socket");
     }
@@ -15,17 +23,22 @@ LibraryServer::LibraryServer(int port) : auditLogger(audit) {
         close(serverSocket);
         throw std::runtime_error("Failed to set socket options");
     }
-    
+
     sockaddr_in serverAddr{};
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_addr.s_addr = INADDR_ANY;
     serverAddr.sin_port = htons(port);
-    
+
     if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+        close(serverSocket);
         throw std::runtime_error("Failed to bind socket");
     }
-    
-    running = false;
+
+    char hostname[256];
+    machineName = "unknown";
+    if (gethostname(hostname, sizeof(hostname)) == 0) {
+        machineName = hostname;
+    }
 }
 
 LibraryServer::~LibraryServer() {
@@ -33,76 +46,354 @@ LibraryServer::~LibraryServer() {
 }
 
 void LibraryServer::Start() {
+    if (listen(serverSocket, config.backlog) < 0) {
+        throw std::runtime_error("Failed to listen on socket");
+    }
+
+    for (int i = 0; i < config.ioThreads; i++) {
+        int epollFd = epoll_create1(EPOLL_CLOEXEC);
+        int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0) {
+            if (epollFd >= 0) close(epollFd);
+            if (wakeFd >= 0) close(wakeFd);
+            Stop();
+            throw std::runtime_error("Failed to create event loop");
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+        epollFds.push_back(epollFd);
+        wakeFds.push_back(wakeFd);
+    }
+
+    workers = std::make_unique<ThreadPool>(config.workerThreads);
     running = true;
-    listen(serverSocket, 5);
-    
+    for (size_t i = 0; i < epollFds.size(); i++) {
+        ioThreads.emplace_back(&LibraryServer::RunEventLoop, this, epollFds[i], wakeFds[i]);
+    }
+
+    size_t nextLoop = 0;
     while (running) {
         sockaddr_in clientAddr{};
         socklen_t clientLen = sizeof(clientAddr);
-        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
-        
-        if (clientSocket >= 0) {
-            clientThreads.emplace_back(&LibraryServer::HandleClient, this, clientSocket);
+        int clientSocket = accept4(serverSocket, (struct sockaddr*)&clientAddr, &clientLen,
+                                   SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientSocket < 0) {
+            if (!running) break;
+            if (errno == EMFILE || errno == ENFILE) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            continue;
         }
+
+        char clientIp[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIp, sizeof(clientIp));
+        AddConnection(clientSocket, clientIp, nextLoop);
+        nextLoop = (nextLoop + 1) % epollFds.size();
     }
 }
 
 void LibraryServer::Stop() {
     running = false;
-    close(serverSocket);
-    for (auto& thread : clientThreads) {
+    if (serverSocket >= 0) {
+        shutdown(serverSocket, SHUT_RDWR);
+    }
+
+    for (int wakeFd : wakeFds) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+    for (auto& thread : ioThreads) {
         if (thread.joinable()) {
             thread.join();
         }
     }
-}
+    ioThreads.clear();
 
-void LibraryServer::HandleClient(int clientSocket) {
-    char buffer[1024];
-    char clientIp[INET_ADDRSTRLEN];
-    char hostname[256];
-    struct sockaddr_in addr;
-    socklen_t addr_size = sizeof(struct sockaddr_in);
+    // Lets in-flight requests finish before their sockets go away.
+    workers.reset();
 
-    getpeername(clientSocket, (struct sockaddr *)&addr, &addr_size);
-    inet_ntop(AF_INET, &addr.sin_addr, clientIp, sizeof(clientIp));
+    std::unordered_map<int, std::shared_ptr<Connection>> remaining;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        remaining.swap(connections);
+    }
+    for (auto& entry : remaining) {
+        libraryManager.ClearSession(entry.first);
+        close(entry.first);
+    }
 
-    std::string machineName = "unknown";
-    if (gethostname(hostname, sizeof(hostname)) == 0) {
-        machineName = hostname;
+    for (int epollFd : epollFds) close(epollFd);
+    for (int wakeFd : wakeFds) close(wakeFd);
+    epollFds.clear();
+    wakeFds.clear();
+
+    if (serverSocket >= 0) {
+        close(serverSocket);
+        serverSocket = -1;
+    }
+}
+
+void LibraryServer::AddConnection(int clientSocket, const std::string& clientIp, size_t loop) {
+    auto conn = std::make_shared<Connection>();
+    conn->socket = clientSocket;
+    conn->epollFd = epollFds[loop];
+    conn->clientIp = clientIp;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        connections[clientSocket] = conn;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = clientSocket;
+    if (epoll_ctl(conn->epollFd, EPOLL_CTL_ADD, clientSocket, &event) < 0) {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        connections.erase(clientSocket);
+        close(clientSocket);
     }
+}
+
+std::shared_ptr<LibraryServer::Connection> LibraryServer::FindConnection(int clientSocket) {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    auto it = connections.find(clientSocket);
+    return it != connections.end() ? it->second : nullptr;
+}
 
+void LibraryServer::RunEventLoop(int epollFd, int wakeFd) {
+    epoll_event events[64];
     while (running) {
-        ssize_t bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-        if (bytesRead <= 0) break;
-        
-        buffer[bytesRead] = '\0';
-        std::string request(buffer);
-
-        AuditLogDto log;
-        log.ClientIp = std::string(clientIp);
-        log.Action = "Request";
-        log.Description = request;
-        log.DateCreated = std::time(nullptr);
-        log.MachineName = machineName;
-        auditLogger.LogAsync(log);
-
-        ProcessRequest(clientSocket, request);
-    }
-    AuditLogDto disconnectLog;
-    disconnectLog.ClientIp = std::string(clientIp);
-    disconnectLog.Action = "Client Disconnected";
-    disconnectLog.Description = "Client connection closed";
-    disconnectLog.DateCreated = std::time(nullptr);
-    disconnectLog.MachineName = machineName;
-    auditLogger.LogAsync(disconnectLog);
-    close(clientSocket);
-}
-
-void LibraryServer::ProcessRequest(int clientSocket, const std::string& request) {
+        int ready = epoll_wait(epollFd, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed: " << errno << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.fd == wakeFd) continue;
+
+            auto conn = FindConnection(events[i].data.fd);
+            if (!conn) continue;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                CloseConnection(conn);
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                HandleReadable(conn);
+            }
+            if (events[i].events & EPOLLOUT) {
+                HandleWritable(conn);
+            }
+        }
+    }
+}
+
+void LibraryServer::HandleReadable(const std::shared_ptr<Connection>& conn) {
+    char buffer[16384];
+    std::vector<std::string> requests;
+    bool peerClosed = false;
+    bool failed = false;
+
+    // Edge-triggered: keep reading until the socket reports it is drained.
+    while (true) {
+        ssize_t bytesRead = recv(conn->socket, buffer, sizeof(buffer), 0);
+        if (bytesRead > 0) {
+            conn->decoder.Feed(buffer, bytesRead);
+            std::string request;
+            while (conn->decoder.Next(request)) {
+                requests.push_back(std::move(request));
+            }
+            if (conn->decoder.Failed()) {
+                std::cerr << "Oversized frame from " << conn->clientIp << ", closing connection" << std::endl;
+                failed = true;
+                break;
+            }
+            continue;
+        }
+        if (bytesRead < 0 && errno == EINTR) continue;
+        if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        peerClosed = bytesRead == 0;
+        failed = !peerClosed;
+        break;
+    }
+
+    if (failed) {
+        CloseConnection(conn);
+        return;
+    }
+
+    bool schedule = false;
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->closed) return;
+        for (auto& request : requests) {
+            conn->pending.push_back(std::move(request));
+        }
+        if (!conn->pending.empty() && !conn->processing) {
+            conn->processing = true;
+            schedule = true;
+        }
+        // A client may send its last requests together with EOF; they are
+        // still answered, and the connection closes after the last reply.
+        if (peerClosed) {
+            conn->readClosed = true;
+            finished = FinishedLocked(*conn);
+        }
+    }
+    if (schedule) {
+        workers->Submit([this, conn]{ DrainRequests(conn); });
+    }
+    if (finished) {
+        CloseConnection(conn);
+    }
+}
+
+// Caller must hold conn.mutex. True once a half-closed connection has
+// nothing left to answer or send.
+bool LibraryServer::FinishedLocked(const Connection& conn) {
+    return conn.readClosed && !conn.processing && conn.pending.empty() && conn.outbound.empty();
+}
+
+void LibraryServer::HandleWritable(const std::shared_ptr<Connection>& conn) {
+    bool failed = false;
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        size_t written = 0;
+        while (!conn->closed && written < conn->outbound.size()) {
+            ssize_t sent = send(conn->socket, conn->outbound.data() + written,
+                                conn->outbound.size() - written, MSG_NOSIGNAL);
+            if (sent > 0) {
+                written += sent;
+            } else if (sent < 0 && errno == EINTR) {
+                continue;
+            } else {
+                failed = !(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+                break;
+            }
+        }
+        conn->outbound.erase(0, written);
+        finished = FinishedLocked(*conn);
+    }
+    if (failed || finished) {
+        CloseConnection(conn);
+    }
+}
+
+void LibraryServer::DrainRequests(std::shared_ptr<Connection> conn) {
+    while (true) {
+        std::string request;
+        bool closed;
+        bool finished;
+        {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            closed = conn->closed;
+            if (closed || conn->pending.empty()) {
+                conn->processing = false;
+                finished = FinishedLocked(*conn);
+                if (!closed) {
+                    // The last reply to a half-closed peer has been written.
+                    if (finished) break;
+                    return;
+                }
+            } else {
+                request = std::move(conn->pending.front());
+                conn->pending.pop_front();
+            }
+        }
+        if (closed) {
+            // The connection closed while this worker owned it.
+            ReleaseConnection(conn);
+            return;
+        }
+        ProcessRequest(conn, request);
+    }
+    CloseConnection(conn);
+}
+
+void LibraryServer::SendResponse(const std::shared_ptr<Connection>& conn, const std::string& response) {
+    bool failed = false;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->closed) return;
+
+        size_t written = 0;
+        if (conn->outbound.empty()) {
+            while (written < response.size()) {
+                ssize_t sent = send(conn->socket, response.data() + written,
+                                    response.size() - written, MSG_NOSIGNAL);
+                if (sent > 0) {
+                    written += sent;
+                } else if (sent < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    failed = !(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+                    break;
+                }
+            }
+        }
+        // Whatever the socket did not take is flushed on the next EPOLLOUT.
+        if (!failed && written < response.size()) {
+            conn->outbound.append(response, written, std::string::npos);
+        }
+    }
+    if (failed) {
+        CloseConnection(conn);
+    }
+}
+
+void LibraryServer::CloseConnection(const std::shared_ptr<Connection>& conn) {
+    bool busy;
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        if (conn->closed) return;
+        conn->closed = true;
+        conn->pending.clear();
+        conn->outbound.clear();
+        busy = conn->processing;
+    }
+    epoll_ctl(conn->epollFd, EPOLL_CTL_DEL, conn->socket, nullptr);
+    LogEvent(conn->clientIp, "Client Disconnected", "Client connection closed");
+
+    // A worker still holding the connection releases it when it finishes, so
+    // the descriptor cannot be reused while a reply is being written to it.
+    if (!busy) {
+        ReleaseConnection(conn);
+    }
+}
+
+void LibraryServer::ReleaseConnection(const std::shared_ptr<Connection>& conn) {
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        auto it = connections.find(conn->socket);
+        if (it == connections.end() || it->second != conn) return;
+        connections.erase(it);
+    }
+    libraryManager.ClearSession(conn->socket);
+    close(conn->socket);
+}
+
+void LibraryServer::ProcessRequest(const std::shared_ptr<Connection>& conn, const std::string& request) {
+    LogEvent(conn->clientIp, "Request", request);
     std::cout << "Received request: " << request << std::endl;
-    // std::string response = "Server received: " + request;
-    //libraryManager.
-    std::string response = libraryManager.ProcessCommand(clientSocket, request);
-    send(clientSocket, response.c_str(), response.length(), 0);
-}
\ No newline at end of file
+    // Rendered straight into this worker's framed buffer and sent from it.
+    ResponseBuffer& response = ResponseBuffer::ForThisThread();
+    response.Clear();
+    libraryManager.ProcessCommand(conn->socket, request, response);
+    SendResponse(conn, response.Frame());
+}
+
+void LibraryServer::LogEvent(const std::string& clientIp, const std::string& action, const std::string& description) {
+    AuditLogDto log;
+    log.ClientIp = clientIp;
+    log.Action = action;
+    log.Description = description;
+    log.DateCreated = std::time(nullptr);
+    log.MachineName = machineName;
+    auditLogger.LogAsync(log);
+}
@@ -3,7 +3,10 @@
 
 #include <thread>
 #include <vector>
+#include <deque>
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <unordered_map>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -12,25 +15,68 @@
 #include "../Interfaces/LibraryManager.hpp"
 #include "../Interfaces/Audits.hpp"
 #include "../Utils/AuditLogger.hpp"
+#include "../Utils/ThreadPool.hpp"
+#include "../Utils/Framing.hpp"
 
+struct ServerConfig {
+    int backlog = 128;        // pending connections queued by listen()
+    int ioThreads = 2;        // epoll loops multiplexing client sockets
+    int workerThreads = 4;    // threads running LibraryManager::ProcessCommand
+};
+
+// Edge-triggered epoll reactor speaking the length-prefixed protocol from
+// Utils/Framing.hpp. Accepted sockets are spread round-robin over a
+// fixed set of I/O threads; requests are handed to a worker pool, at most one
+// in flight per connection so replies keep their order.
 class LibraryServer {
 private:
+    struct Connection {
+        int socket;
+        int epollFd;
+        std::string clientIp;
+        Utils::FrameDecoder decoder;       // touched only by the connection's I/O thread
+        std::mutex mutex;
+        std::deque<std::string> pending;   // requests waiting for a worker
+        std::string outbound;              // reply bytes the socket could not take yet
+        bool processing = false;           // a worker is draining pending
+        bool readClosed = false;           // peer sent EOF; close once its requests are answered
+        bool closed = false;
+    };
+
     int serverSocket;
-    std::vector<std::thread> clientThreads;
-    bool running;
+    ServerConfig config;
+    std::atomic<bool> running;
+    std::string machineName;
     LibraryManager libraryManager;
 
     Audits audit;
     AuditLogger auditLogger;
-    
-    void HandleClient(int clientSocket);
-    void ProcessRequest(int clientSocket, const std::string& request);
-    
+
+    std::vector<int> epollFds;
+    std::vector<int> wakeFds;
+    std::vector<std::thread> ioThreads;
+    std::unique_ptr<ThreadPool> workers;
+    std::mutex connectionsMutex;
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+
+    void AddConnection(int clientSocket, const std::string& clientIp, size_t loop);
+    std::shared_ptr<Connection> FindConnection(int clientSocket);
+    void RunEventLoop(int epollFd, int wakeFd);
+    void HandleReadable(const std::shared_ptr<Connection>& conn);
+    void HandleWritable(const std::shared_ptr<Connection>& conn);
+    void DrainRequests(std::shared_ptr<Connection> conn);
+    static bool FinishedLocked(const Connection& conn);
+    void SendResponse(const std::shared_ptr<Connection>& conn, const std::string& response);
+    void CloseConnection(const std::shared_ptr<Connection>& conn);
+    void ReleaseConnection(const std::shared_ptr<Connection>& conn);
+    void ProcessRequest(const std::shared_ptr<Connection>& conn, const std::string& request);
+    void LogEvent(const std::string& clientIp, const std::string& action, const std::string& description);
+
 public:
-    LibraryServer(int port);
+    LibraryServer(int port, const ServerConfig& serverConfig = ServerConfig());
     ~LibraryServer();
     void Start();
     void Stop();
 };
 
-#endif
\ No newline at end of file
+#endif
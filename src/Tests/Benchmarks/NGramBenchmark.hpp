@@ -0,0 +1,175 @@
+#ifndef NGRAM_BENCHMARK_HPP
+#define NGRAM_BENCHMARK_HPP
+
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../../Utils/NGramUtils.hpp"
+
+class NGramBenchmark {
+private:
+    const size_t TITLE_COUNT = 2000;
+    const size_t QUERY_COUNT = 100;
+
+    // The set-based kernel SearchBooks used before, kept as the reference result.
+    static double LegacySimilarity(const std::string& s1, const std::string& s2) {
+        if (s1.length() < 2 || s2.length() < 2) return 0.0;
+
+        std::set<std::string> ngrams1, ngrams2;
+        for (size_t i = 0; i <= s1.length() - 2; i++)
+            ngrams1.insert(s1.substr(i, 2));
+        for (size_t i = 0; i <= s2.length() - 2; i++)
+            ngrams2.insert(s2.substr(i, 2));
+
+        int common = 0;
+        for (const auto& ngram : ngrams1) {
+            if (ngrams2.find(ngram) != ngrams2.end())
+                common++;
+        }
+        return (2.0 * common) / (ngrams1.size() + ngrams2.size());
+    }
+
+    // Same coefficient computed straight from the strings without allocating:
+    // bigrams are marked in per-thread 65536-bit sets that are cleared again
+    // by walking the same strings. Compared against the signature kernel
+    // SearchBooks uses, which pays for its signatures once at load time.
+    static double BitsetSimilarity(const std::string& s1, const std::string& s2) {
+        if (s1.size() < 2 || s2.size() < 2) return 0.0;
+
+        thread_local std::array<uint64_t, 1024> seen1{};
+        thread_local std::array<uint64_t, 1024> seen2{};
+
+        size_t distinct1 = 0;
+        for (size_t i = 0; i + 1 < s1.size(); i++) {
+            uint16_t code = Utils::PackBigram(s1[i], s1[i + 1]);
+            uint64_t bit = uint64_t{1} << (code & 63);
+            if (!(seen1[code >> 6] & bit)) {
+                seen1[code >> 6] |= bit;
+                distinct1++;
+            }
+        }
+
+        size_t distinct2 = 0;
+        size_t common = 0;
+        for (size_t i = 0; i + 1 < s2.size(); i++) {
+            uint16_t code = Utils::PackBigram(s2[i], s2[i + 1]);
+            uint64_t bit = uint64_t{1} << (code & 63);
+            if (!(seen2[code >> 6] & bit)) {
+                seen2[code >> 6] |= bit;
+                distinct2++;
+                if (seen1[code >> 6] & bit) common++;
+            }
+        }
+
+        for (size_t i = 0; i + 1 < s1.size(); i++) {
+            seen1[Utils::PackBigram(s1[i], s1[i + 1]) >> 6] = 0;
+        }
+        for (size_t i = 0; i + 1 < s2.size(); i++) {
+            seen2[Utils::PackBigram(s2[i], s2[i + 1]) >> 6] = 0;
+        }
+
+        return (2.0 * common) / (distinct1 + distinct2);
+    }
+
+    // Reports the first pair a kernel scores differently from the legacy one.
+    static bool Agrees(const char* kernel, const std::string& query, const std::string& title,
+                       double actual, double expected) {
+        if (actual == expected) return true;
+        std::cerr << std::setprecision(17) << kernel << " kernel differs from legacy result for \""
+                  << query << "\" vs \"" << title << "\": " << actual << " != " << expected << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> BuildTitles(std::mt19937& rng, size_t count, int minWords, int maxWords) {
+        const std::vector<std::string> syllables = {
+            "ha", "ry", "pot", "ter", "the", "hob", "bit", "lord", "of", "rings", "war", "and",
+            "pea", "ce", "crime", "pun", "ish", "ment", "great", "gats", "by", "or", "well", "ton"
+        };
+        std::uniform_int_distribution<int> words(minWords, maxWords);
+        std::uniform_int_distribution<int> parts(1, 3);
+        std::uniform_int_distribution<size_t> pick(0, syllables.size() - 1);
+
+        std::vector<std::string> titles;
+        for (size_t i = 0; i < count; i++) {
+            std::string title;
+            int wordCount = words(rng);
+            for (int w = 0; w < wordCount; w++) {
+                if (w > 0) title += ' ';
+                int partCount = parts(rng);
+                for (int p = 0; p < partCount; p++) title += syllables[pick(rng)];
+            }
+            titles.push_back(title);
+        }
+        return titles;
+    }
+
+    template <typename Kernel>
+    double NanosPerCall(const std::vector<std::string>& queries, const std::vector<std::string>& titles,
+                        Kernel kernel, double& checksum) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t q = 0; q < queries.size(); q++) {
+            for (size_t t = 0; t < titles.size(); t++) {
+                checksum += kernel(q, t);
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double calls = static_cast<double>(queries.size() * titles.size());
+        return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+    }
+
+public:
+    // False, with the mismatch on stderr, when the kernels disagree.
+    bool RunAll() {
+        std::mt19937 rng(42);
+        auto titles = BuildTitles(rng, TITLE_COUNT, 1, 6);
+        auto queries = BuildTitles(rng, QUERY_COUNT, 1, 1);
+
+        std::vector<std::vector<uint16_t>> titleSignatures, querySignatures;
+        for (const auto& title : titles) titleSignatures.push_back(Utils::BigramSignature(title));
+        for (const auto& query : queries) querySignatures.push_back(Utils::BigramSignature(query));
+
+        std::cout << "Checking kernels agree on " << queries.size() * titles.size() << " pairs...\n";
+        for (size_t q = 0; q < queries.size(); q++) {
+            for (size_t t = 0; t < titles.size(); t++) {
+                double expected = LegacySimilarity(queries[q], titles[t]);
+                if (!Agrees("Bitset string", queries[q], titles[t],
+                            BitsetSimilarity(queries[q], titles[t]), expected) ||
+                    !Agrees("Packed signature", queries[q], titles[t],
+                            Utils::BigramSimilarity(querySignatures[q], titleSignatures[t]), expected)) {
+                    return false;
+                }
+            }
+        }
+
+        double legacySum = 0.0, stringSum = 0.0, signatureSum = 0.0;
+        double legacyNs = NanosPerCall(queries, titles, [&](size_t q, size_t t) {
+            return LegacySimilarity(queries[q], titles[t]);
+        }, legacySum);
+        double stringNs = NanosPerCall(queries, titles, [&](size_t q, size_t t) {
+            return BitsetSimilarity(queries[q], titles[t]);
+        }, stringSum);
+        double signatureNs = NanosPerCall(queries, titles, [&](size_t q, size_t t) {
+            return Utils::BigramSimilarity(querySignatures[q], titleSignatures[t]);
+        }, signatureSum);
+        if (legacySum != stringSum || legacySum != signatureSum) {
+            std::cerr << std::setprecision(17) << "Kernel checksums differ: legacy " << legacySum
+                      << ", bitset string " << stringSum << ", packed signature " << signatureSum << std::endl;
+            return false;
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Legacy std::set kernel:   " << legacyNs << " ns/call\n"
+                  << "Bitset string kernel:     " << stringNs << " ns/call ("
+                  << legacyNs / stringNs << "x)\n"
+                  << "Packed signature kernel:  " << signatureNs << " ns/call ("
+                  << legacyNs / signatureNs << "x)\n";
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef TRANSACTION_STORAGE_BENCHMARK_HPP
+#define TRANSACTION_STORAGE_BENCHMARK_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "../../Interfaces/Transactions.hpp"
+
+// Compares opening a large ledger from the JSON snapshot against opening the
+// same ledger from the binary record file.
+class TransactionStorageBenchmark {
+private:
+    const size_t TRANSACTION_COUNT = 100000;
+    const std::string BENCH_DIR = "./resources/test/database";
+    const std::string JSON_FILE = BENCH_DIR + "/bench_transactions.json";
+    const std::string BINARY_FILE = BENCH_DIR + "/bench_transactions.bin";
+
+    static size_t HeapInUse() {
+        return mallinfo2().uordblks;
+    }
+
+    void WriteLedger() {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> user(1, 5000), book(1, 20000), status(0, 1);
+        std::uniform_int_distribution<long> offset(0, 3L * 365 * 86400);
+        const std::time_t start = 1600000000;
+
+        nlohmann::json j = nlohmann::json::array();
+        for (size_t i = 1; i <= TRANSACTION_COUNT; i++) {
+            std::time_t borrowed = start + offset(rng);
+            j.push_back({
+                {"TransactionId", i}, {"UserId", user(rng)}, {"BookId", book(rng)},
+                {"CreatedDate", borrowed}, {"BorrowDate", borrowed}, {"DueDate", borrowed + 5 * 86400},
+                {"ReturnDate", 0}, {"ActualReturnDate", 0}, {"Status", status(rng)}
+            });
+        }
+        std::ofstream file(JSON_FILE);
+        file << std::setw(4) << j << std::endl;
+    }
+
+    // Times opening the store and reports the heap it keeps while open, then
+    // times the first indexed query, which builds the indexes.
+    // Negative when the reopened ledger lost records or its index.
+    double MillisToOpen(const std::string& path, StorageMode mode, size_t& heapKb, double& firstQueryMs) {
+        size_t before = HeapInUse();
+        auto started = std::chrono::steady_clock::now();
+        auto transactions = std::make_unique<Transactions>(path, mode);
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        heapKb = (HeapInUse() - before) / 1024;
+        if (transactions->GetTransactionById(static_cast<int>(TRANSACTION_COUNT)).TransactionId == 0) {
+            std::cerr << "Benchmark ledger " << path << " lost records" << std::endl;
+            return -1;
+        }
+
+        auto queried = std::chrono::steady_clock::now();
+        if (transactions->GetTransactionsByUserId(1).empty()) {
+            std::cerr << "Benchmark ledger " << path << " lost its index" << std::endl;
+            return -1;
+        }
+        firstQueryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queried).count();
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    // Times flipping loans between BORROWED and RETURNED, as returns do, in an
+    // index over the whole ledger.
+    double MillisForStatusChanges(size_t changes) {
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> user(1, 5000), book(1, 20000), status(0, 1);
+        std::vector<TransactionsDto> ledger;
+        TransactionIndex index;
+        for (size_t i = 1; i <= TRANSACTION_COUNT; i++) {
+            TransactionsDto transaction{};
+            transaction.TransactionId = static_cast<int>(i);
+            transaction.UserId = user(rng);
+            transaction.BookId = book(rng);
+            transaction.BorrowDate = 1600000000 + static_cast<std::time_t>(i) * 60;
+            transaction.DueDate = transaction.BorrowDate + 5 * 86400;
+            transaction.Status = static_cast<BorrowStatus>(status(rng));
+            index.Add(transaction);
+            ledger.push_back(transaction);
+        }
+
+        std::uniform_int_distribution<size_t> pick(0, TRANSACTION_COUNT - 1);
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < changes; i++) {
+            TransactionsDto& transaction = ledger[pick(rng)];
+            TransactionsDto previous = transaction;
+            transaction.Status = transaction.Status == BorrowStatus::BorrowStatus_BORROWED
+                ? BorrowStatus::BorrowStatus_RETURNED : BorrowStatus::BorrowStatus_BORROWED;
+            index.Update(previous, transaction);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        return std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+
+    void CleanUp() {
+        for (const auto& path : {JSON_FILE, BINARY_FILE}) {
+            std::filesystem::remove(path);
+            std::filesystem::remove(path + ".seq");
+        }
+    }
+
+public:
+    // False, with the reason on stderr, when the ledger does not survive conversion.
+    bool RunAll() {
+        std::filesystem::create_directories(BENCH_DIR);
+        CleanUp();
+        WriteLedger();
+        if (!Transactions::ConvertJsonToBinary(JSON_FILE, BINARY_FILE)) {
+            std::cerr << "Failed to convert " << JSON_FILE << " to " << BINARY_FILE << std::endl;
+            CleanUp();
+            return false;
+        }
+
+        size_t jsonKb = 0, binaryKb = 0;
+        double jsonQueryMs = 0, binaryQueryMs = 0;
+        double jsonMs = MillisToOpen(JSON_FILE, StorageMode::SNAPSHOT, jsonKb, jsonQueryMs);
+        double binaryMs = MillisToOpen(BINARY_FILE, StorageMode::BINARY, binaryKb, binaryQueryMs);
+        if (jsonMs < 0 || binaryMs < 0) {
+            CleanUp();
+            return false;
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << TRANSACTION_COUNT << " transactions: JSON "
+                  << std::filesystem::file_size(JSON_FILE) / 1024 << " KiB, binary "
+                  << std::filesystem::file_size(BINARY_FILE) / 1024 << " KiB\n"
+                  << "JSON snapshot load:  " << jsonMs << " ms, " << jsonKb << " KiB heap\n"
+                  << "Binary file load:    " << binaryMs << " ms (" << jsonMs / binaryMs << "x), "
+                  << binaryKb << " KiB heap\n"
+                  << "First indexed query: JSON " << jsonQueryMs << " ms, binary " << binaryQueryMs << " ms\n";
+
+        const size_t changes = 20000;
+        std::cout << "Index status changes: " << MillisForStatusChanges(changes) << " ms for " << changes << "\n";
+        CleanUp();
+        return true;
+    }
+};
+
+#endif
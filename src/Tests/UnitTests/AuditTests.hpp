@@ -0,0 +1,186 @@
+#ifndef AUDIT_TESTS_HPP
+#define AUDIT_TESTS_HPP
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include "../../Interfaces/Audits.hpp"
+#include "../../Utils/AuditLogger.hpp"
+
+namespace fs = std::filesystem;
+
+class AuditTests {
+private:
+    const std::string TEST_DIR = "./resources/test/database";
+    const std::string TEST_FILE = TEST_DIR + "/test_audits.jsonl";
+
+    void SetUp() {
+        TearDown();
+        fs::create_directories(TEST_DIR);
+        std::ofstream file(TEST_FILE);
+        file.close();
+        std::cout << "Test file created at: " << TEST_FILE << std::endl;
+    }
+
+    void TearDown() {
+        RemoveSegments(TEST_FILE);
+    }
+
+    // Removes an audit file together with its sealed segments and sidecars.
+    void RemoveSegments(const std::string& path) {
+        std::string prefix = fs::path(path).filename().string();
+        if (!fs::exists(TEST_DIR)) return;
+        for (const auto& entry : fs::directory_iterator(TEST_DIR)) {
+            if (entry.path().filename().string().compare(0, prefix.size(), prefix) == 0) {
+                fs::remove(entry.path());
+            }
+        }
+    }
+
+    AuditLogDto MakeLog(const std::string& description) {
+        AuditLogDto log{};
+        log.ClientIp = "127.0.0.1";
+        log.MachineName = "test";
+        log.Action = "Request";
+        log.Description = description;
+        log.DateCreated = std::time(nullptr);
+        return log;
+    }
+
+    void TestAddAuditLogs() {
+        Audits audits(TEST_FILE);
+        assert(audits.AddAuditLog(MakeLog("first")) && "Add audit log failed");
+        assert(audits.AddAuditLogs({MakeLog("second"), MakeLog("third \"quoted\"")}) && "Add audit batch failed");
+
+        auto logs = audits.GetAllAuditLogs();
+        assert(logs.size() == 3 && "Appended logs should stay a readable array");
+        assert(logs[0].AuditLogId == 1 && logs[2].AuditLogId == 3 && "Batch ids should be sequential");
+        assert(logs[2].Description == "third \"quoted\"" && "Description should round trip");
+        std::cout << "Add audit logs test passed\n";
+    }
+
+    void TestLoggerFlushesBatches() {
+        Audits audits(TEST_FILE);
+        size_t before = audits.GetAllAuditLogs().size();
+        {
+            AuditLoggerConfig config;
+            config.maxBatchSize = 16;
+            config.maxLatency = std::chrono::milliseconds(5);
+            AuditLogger logger(audits, config);
+            for (int i = 0; i < 100; i++) {
+                assert(logger.LogAsync(MakeLog("log " + std::to_string(i))) && "Blocking logger should not drop");
+            }
+        }
+        auto logs = audits.GetAllAuditLogs();
+        assert(logs.size() == before + 100 && "Logger should persist every queued log on shutdown");
+        assert(logs.back().Description == "log 99" && "Logs should be persisted in order");
+        std::cout << "Logger batching test passed\n";
+    }
+
+    void TestDropNewestPolicy() {
+        Audits audits(TEST_FILE);
+        AuditLoggerConfig config;
+        config.queueCapacity = 1;
+        config.maxLatency = std::chrono::milliseconds(200);
+        config.policy = BackpressurePolicy::DROP_NEWEST;
+        AuditLogger logger(audits, config);
+
+        size_t accepted = 0;
+        for (int i = 0; i < 50; i++) {
+            if (logger.LogAsync(MakeLog("burst"))) accepted++;
+        }
+        assert(accepted + logger.DroppedLogs() == 50 && "Every log should be accepted or counted as dropped");
+        assert(logger.DroppedLogs() > 0 && "A full queue should drop new logs");
+        std::cout << "Drop newest policy test passed\n";
+    }
+
+    void TestLegacyMigration() {
+        const std::string legacyFile = TEST_DIR + "/test_audits_legacy.json";
+        RemoveSegments(legacyFile);
+        std::ofstream file(legacyFile);
+        file << "[\n    {\"AuditLogId\": 4, \"Action\": \"Request\", \"ClientIp\": \"10.0.0.1\",\n"
+                "     \"DateCreated\": 1736709448, \"Description\": \"1\", \"MachineName\": \"host\"}\n]";
+        file.close();
+
+        {
+            Audits audits(legacyFile);
+            assert(audits.AddAuditLog(MakeLog("after migration")) && "Append after migration failed");
+            auto logs = audits.GetAllAuditLogs();
+            assert(logs.size() == 2 && "Migrated file should keep its records");
+            assert(logs[0].ClientIp == "10.0.0.1" && "Migrated record should round trip");
+            assert(logs[1].AuditLogId == 5 && "Ids should continue after the migrated records");
+            // The migrated record is far older than a day, so the first append sealed its segment.
+            audits.WaitForCompression();
+            assert(fs::exists(legacyFile + ".000001.gz") && "An aged segment should be rotated");
+        }
+        RemoveSegments(legacyFile);
+        std::cout << "Legacy migration test passed\n";
+    }
+
+    void TestRotation() {
+        TearDown();
+        AuditRotationPolicy policy;
+        policy.maxSegmentBytes = 1024;
+        policy.compressRotated = true;
+        Audits audits(TEST_FILE, policy);
+
+        for (int i = 0; i < 60; i++) {
+            assert(audits.AddAuditLog(MakeLog("rotated " + std::to_string(i))) && "Add audit log failed");
+        }
+        assert(audits.GetAllAuditLogs().size() == 60 && "Segments awaiting compression should stay readable");
+
+        audits.WaitForCompression();
+        size_t sealed = 0;
+        for (const auto& entry : fs::directory_iterator(TEST_DIR)) {
+            if (entry.path().extension() == ".gz") sealed++;
+        }
+        assert(sealed >= 2 && "Segments over the size limit should be sealed and compressed");
+        assert(fs::file_size(TEST_FILE) < 1024 + 256 && "The active segment should stay near the size limit");
+
+        int expected = 0;
+        audits.ForEachAuditLog([&expected](const AuditLogDto& log) {
+            assert(log.Description == "rotated " + std::to_string(expected) && "Segments should stream in order");
+            expected++;
+            return true;
+        });
+        assert(expected == 60 && "Every record should be readable across segments");
+        std::cout << "Rotation test passed\n";
+    }
+
+    void TestStaleSequenceIsReseeded() {
+        // A sidecar left behind by an older copy of the trail.
+        {
+            std::ofstream sequence(TEST_FILE + ".seq");
+            sequence << "00000000001\n";
+        }
+        Audits audits(TEST_FILE);
+        assert(audits.AddAuditLog(MakeLog("after restore")) && "Add audit log failed");
+        auto logs = audits.GetAllAuditLogs();
+        assert(logs.size() == 61 && logs.back().AuditLogId == 61 &&
+               "Ids should continue after the newest record, not the stale sidecar");
+        std::cout << "Stale sequence test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        try {
+            SetUp();
+            std::cout << "Running audit tests...\n";
+            TestAddAuditLogs();
+            TestLoggerFlushesBatches();
+            TestDropNewestPolicy();
+            TestLegacyMigration();
+            TestRotation();
+            TestStaleSequenceIsReseeded();
+            TearDown();
+            std::cout << "All audit tests passed!\n";
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Test failed: " << e.what() << std::endl;
+            TearDown();
+            throw;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef AUTH_POOL_TESTS_HPP
+#define AUTH_POOL_TESTS_HPP
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "../../Utils/AuthPool.hpp"
+
+class AuthPoolTests {
+private:
+    void TestHashMatchesInline() {
+        AuthPool pool(2, 8);
+        auto hashed = pool.Hash("jane@test.com", "password123");
+        assert(hashed && *hashed == Utils::CreateSaltedHash("jane@test.com", "password123") &&
+               "The pool should produce the same hash as hashing inline");
+
+        std::atomic<int> matched{0};
+        std::vector<std::thread> callers;
+        for (int i = 0; i < 4; i++) {
+            callers.emplace_back([&pool, &matched, i]() {
+                for (int j = 0; j < 25; j++) {
+                    std::string password = "pw" + std::to_string(i * 100 + j);
+                    auto result = pool.Hash("user@test.com", password);
+                    if (result && *result == Utils::CreateSaltedHash("user@test.com", password)) matched++;
+                }
+            });
+        }
+        for (auto& caller : callers) caller.join();
+        assert(matched == 100 && "Every caller should get its own hash back");
+
+        auto stats = pool.Stats();
+        assert(stats.completed == 101 && stats.rejected == 0 && stats.threads == 2 &&
+               "Completed hashes should be counted");
+        assert(stats.queueDepth == 0 && stats.queueCapacity == 8 && "The queue should be empty when idle");
+        std::cout << "Hash matches inline test passed\n";
+    }
+
+    void TestFullQueueIsRefused() {
+        std::mutex gateMutex;
+        std::condition_variable gateOpened;
+        bool open = false;
+        std::atomic<int> started{0};
+        AuthPool pool(1, 1, [&](const std::string& salt, const std::string& password) {
+            started++;
+            std::unique_lock<std::mutex> lock(gateMutex);
+            gateOpened.wait(lock, [&open] { return open; });
+            return Utils::CreateSaltedHash(salt, password);
+        });
+
+        // One hash running and one queued fill the pool.
+        std::thread running([&pool]() { assert(pool.Hash("a@test.com", "first") && "Running hash lost"); });
+        while (started == 0) std::this_thread::yield();
+        std::thread queued([&pool]() { assert(pool.Hash("b@test.com", "second") && "Queued hash lost"); });
+        while (pool.Stats().queueDepth == 0) std::this_thread::yield();
+
+        assert(!pool.Hash("c@test.com", "third") && "A full queue should refuse at once");
+        assert(pool.Stats().rejected == 1 && pool.Stats().queueDepth == 1 && "The refusal should be counted");
+
+        {
+            std::lock_guard<std::mutex> lock(gateMutex);
+            open = true;
+        }
+        gateOpened.notify_all();
+        running.join();
+        queued.join();
+
+        auto stats = pool.Stats();
+        assert(stats.completed == 2 && stats.maxHashMicros >= stats.averageHashMicros &&
+               "Accepted hashes should finish once the pool frees up");
+        std::cout << "Full queue test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running auth pool tests...\n";
+        TestHashMatchesInline();
+        TestFullQueueIsRefused();
+        std::cout << "All auth pool tests passed!\n";
+    }
+};
+
+#endif
@@ -4,6 +4,8 @@
 
 #include <cassert>
 #include <filesystem>
+#include <thread>
+#include <atomic>
 #include "../../Interfaces/Books.hpp"
 
 namespace fs = std::filesystem;
@@ -18,6 +20,7 @@ private:
         std::ofstream file(TEST_FILE);
         file << "[]";
         file.close();
+        fs::remove(TEST_FILE + ".seq");
         std::cout << "Test file created at: " << TEST_FILE << std::endl;
     }
 
@@ -51,6 +54,10 @@ private:
         Books books(TEST_FILE);
         auto book = books.GetBooksById(1);
         assert(book.BookId == 1 && "Get book failed");
+
+        auto batch = books.GetBooksByIds({1, 1, 9999});
+        assert(batch.size() == 1 && batch.at(1).Name == book.Name &&
+               "Batch lookup should resolve each known id once and skip missing ones");
     }
 
     void TestRemoveBook() {
@@ -68,6 +75,31 @@ private:
         assert(book.NoOfCopies == 6 && "Copies not added correctly");
     }
 
+    void TestReserveCopy() {
+        Books books(TEST_FILE);
+        int available = books.GetBooksById(1).NoOfCopies;
+
+        std::atomic<int> reserved{0};
+        std::vector<std::thread> borrowers;
+        for (int i = 0; i < 8; i++) {
+            borrowers.emplace_back([&books, &reserved]() {
+                for (int attempt = 0; attempt < 2; attempt++) {
+                    if (books.TryReserveCopy(1)) reserved++;
+                }
+            });
+        }
+        for (auto& borrower : borrowers) borrower.join();
+        assert(reserved == available && "Exactly the available copies should be reserved");
+        assert(books.GetBooksById(1).NoOfCopies == 0 && "The copy count should never go negative");
+        assert(!books.TryReserveCopy(1) && !books.TryReserveCopy(999) && "Nothing left to reserve");
+
+        for (int i = 0; i < available; i++) {
+            assert(books.ReleaseCopy(1) && "Release copy failed");
+        }
+        assert(Books(TEST_FILE).GetBooksById(1).NoOfCopies == available && "Releases should be persisted");
+        std::cout << "Reserve copy test passed\n";
+    }
+
     void TestSearchBooks() {
         Books books(TEST_FILE);
         
@@ -83,7 +115,7 @@ private:
                 .DateCreated = std::time(nullptr),
                 .DateUpdated = std::time(nullptr),
                 .Status = BookStatus::BookStatus_ACTIVE,
-                .Categories = {}
+                .CategoryIds = {}
             },
             {
                 .BookId = 2,
@@ -95,7 +127,7 @@ private:
                 .DateCreated = std::time(nullptr),
                 .DateUpdated = std::time(nullptr),
                 .Status = BookStatus::BookStatus_ACTIVE,
-                .Categories = {},
+                .CategoryIds = {},
             },
             {
                 .BookId = 3,
@@ -107,7 +139,7 @@ private:
                 .DateCreated = std::time(nullptr),
                 .DateUpdated = std::time(nullptr),
                 .Status = BookStatus::BookStatus_ACTIVE,
-                .Categories = {}
+                .CategoryIds = {}
             }
         };
         
@@ -162,10 +194,109 @@ private:
         results = books.SearchBooks("the");
         assert(results.size() > 1 && "Should find multiple results");
         assert(results[0].score >= results[1].score && "Results should be sorted by relevance");
+
+        // Paging one result at a time walks the same ranking
+        Books::SearchPosition position{};
+        for (size_t i = 0; i < results.size(); i++) {
+            auto page = books.SearchBooks("the", 1, i == 0 ? nullptr : &position);
+            assert(page.size() == 1 && page[0].book.BookId == results[i].book.BookId &&
+                   "Each page should resume after the previous one");
+            position = {page[0].score, page[0].book.BookId};
+        }
+        assert(books.SearchBooks("the", 1, &position).empty() && "Paging should end after the last result");
+        
+        // Single-character tokens are ignored rather than matching everything
+        results = books.SearchBooks("a");
+        assert(results.empty() && "Single-character query should not match");
         
         std::cout << "Book search tests passed!\n";
     }
 
+    void TestSearchTracksRemovals() {
+        Books books(TEST_FILE);
+        BooksDto book{};
+        book.Name = "Zanzibar Chronicles";
+        book.Author = "Quill Stone";
+        book.NoOfCopies = 1;
+        book.Status = BookStatus::BookStatus_ACTIVE;
+        assert(books.AddBook(book) && "Add book failed");
+
+        auto results = books.SearchBooks("zanzibar");
+        assert(!results.empty() && results[0].book.Name == "Zanzibar Chronicles" &&
+               "New book should be searchable immediately");
+
+        assert(books.RemoveBook(results[0].book.BookId) && "Remove book failed");
+        results = books.SearchBooks("zanzibar");
+        for (const auto& result : results) {
+            assert(result.book.Name != "Zanzibar Chronicles" && "Removed book still searchable");
+        }
+    }
+
+    void TestIdsAreNotReused() {
+        Books books(TEST_FILE);
+        BooksDto book{};
+        book.Name = "Sequence Probe";
+        book.NoOfCopies = 1;
+        book.Status = BookStatus::BookStatus_ACTIVE;
+
+        assert(books.AddBook(book) && "Add book failed");
+        int firstId = books.GetAllBooks().back().BookId;
+        assert(books.RemoveBook(firstId) && "Remove book failed");
+
+        Books reopened(TEST_FILE);
+        assert(reopened.AddBook(book) && "Add book failed");
+        int secondId = reopened.GetAllBooks().back().BookId;
+        assert(secondId > firstId && "Removed book id was handed out again");
+        assert(reopened.RemoveBook(secondId) && "Remove book failed");
+    }
+
+    void TestCategoryReferences() {
+        Books books(TEST_FILE);
+        BooksDto book{};
+        book.Name = "Filed Book";
+        book.Author = "Author";
+        book.NoOfCopies = 1;
+        book.Status = BookStatus::BookStatus_ACTIVE;
+        book.CategoryIds = {901, 902};
+        assert(books.AddBook(book) && "Add book failed");
+        book.CategoryIds = {902};
+        assert(books.AddBook(book) && "Add book failed");
+
+        auto filed = books.GetBooksByCategory(902);
+        assert(filed.size() == 2 && filed[0].BookId < filed[1].BookId && "Both books should be filed under 902");
+        assert(books.GetBooksByCategory(901).size() == 1 && "One book should be filed under 901");
+
+        assert(books.DetachCategory(902) && "Detach category failed");
+        assert(books.GetBooksByCategory(902).empty() && "No book should reference a detached category");
+        Books reopened(TEST_FILE);
+        auto remaining = reopened.GetBooksByCategory(901);
+        assert(remaining.size() == 1 && remaining[0].CategoryIds == std::vector<int>({901}) &&
+               "Detaching should be persisted and leave other categories alone");
+        for (const auto& filedBook : filed) {
+            assert(reopened.RemoveBook(filedBook.BookId) && "Remove book failed");
+        }
+        assert(reopened.GetBooksByCategory(901).empty() && "Removed books should leave the index");
+        std::cout << "Category reference test passed\n";
+    }
+
+    void TestLegacyEmbeddedCategories() {
+        std::string legacyFile = TEST_DIR + "/test_books_legacy.json";
+        std::ofstream(legacyFile) <<
+            "[{\"BookId\": 1, \"Name\": \"Old\", \"Status\": 1, \"Categories\": ["
+            "{\"CategoryId\": 4, \"Name\": \"Science\", \"Description\": \"\", \"DateCreated\": 0},"
+            "{\"CategoryId\": 7, \"Name\": \"History\", \"Description\": \"\", \"DateCreated\": 0}]}]";
+        {
+            Books books(legacyFile);
+            assert(books.GetBooksById(1).CategoryIds == std::vector<int>({4, 7}) &&
+                   "Embedded categories should load as ids");
+            assert(books.GetBooksByCategory(7).size() == 1 && "Legacy rows should be indexed");
+        }
+        fs::remove(legacyFile);
+        fs::remove(legacyFile + ".seq");
+        fs::remove(legacyFile + ".lock");
+        std::cout << "Legacy category test passed\n";
+    }
+
 public:
     void RunAllTests() {
         try {
@@ -174,7 +305,12 @@ public:
             TestAddBook();
             TestGetBook();
             TestAddCopies();
+            TestReserveCopy();
             TestSearchBooks();
+            TestSearchTracksRemovals();
+            TestIdsAreNotReused();
+            TestCategoryReferences();
+            TestLegacyEmbeddedCategories();
             // TestRemoveBook();
             // TearDown();
             std::cout << "All book tests passed!\n";
@@ -4,6 +4,7 @@
 #include <cassert>
 #include <filesystem>
 #include "../../Interfaces/Categories.hpp"
+#include "../../Interfaces/Books.hpp"
 
 namespace fs = std::filesystem;
 
@@ -17,6 +18,7 @@ private:
         std::ofstream file(TEST_FILE);
         file << "[]";
         file.close();
+        fs::remove(TEST_FILE + ".seq");
         std::cout << "Test file created at: " << TEST_FILE << std::endl;
     }
 
@@ -49,9 +51,45 @@ private:
     }
 
     void TestRemoveCategory() {
+        const std::string booksFile = TEST_DIR + "/test_category_books.json";
+        std::ofstream(booksFile) << "[]";
         Categories categories(TEST_FILE);
-        bool result = categories.RemoveCategory(1);
+        Books books(booksFile);
+        bool result = categories.RemoveCategory(1, books);
         assert(result && "Remove category failed");
+        fs::remove(booksFile);
+    }
+
+    void TestCascadeRemoval() {
+        const std::string booksFile = TEST_DIR + "/test_category_books.json";
+        std::ofstream(booksFile) << "[]";
+        fs::remove(booksFile + ".seq");
+
+        Categories categories(TEST_FILE);
+        CategoryDto category{};
+        category.Name = "Cascade";
+        assert(categories.AddCategory(category) && "Add category failed");
+        int categoryId = categories.GetAllCategories().back().CategoryId;
+
+        Books books(booksFile);
+        BooksDto book{};
+        book.Name = "Filed";
+        book.Status = BookStatus::BookStatus_ACTIVE;
+        book.CategoryIds = {categoryId, 1};
+        assert(books.AddBook(book) && "Add book failed");
+        auto joined = categories.GetCategoriesByIds(books.GetBooksById(1).CategoryIds);
+        assert(joined.size() == 2 && joined[0].Name == "Cascade" && "Categories should join at read time");
+
+        assert(categories.RemoveCategory(categoryId, books) && "Remove category failed");
+        assert(categories.GetCategoryById(categoryId).CategoryId == 0 && "The category should be gone");
+        assert(books.GetBooksById(1).CategoryIds == std::vector<int>({1}) &&
+               "Books should no longer reference the removed category");
+        assert(Categories(TEST_FILE).GetCategoryById(categoryId).CategoryId == 0 && "Removal should be persisted");
+
+        fs::remove(booksFile);
+        fs::remove(booksFile + ".seq");
+        fs::remove(booksFile + ".lock");
+        std::cout << "Cascade removal test passed\n";
     }
 
 public:
@@ -61,6 +99,7 @@ public:
             std::cout << "Running category tests...\n";
             TestAddCategory();
             TestGetCategory();
+            TestCascadeRemoval();
             // TestRemoveCategory();
             // TearDown();
             std::cout << "All category tests passed!\n";
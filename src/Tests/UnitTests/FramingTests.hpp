@@ -0,0 +1,65 @@
+#ifndef FRAMING_TESTS_HPP
+#define FRAMING_TESTS_HPP
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "../../Utils/Framing.hpp"
+
+class FramingTests {
+private:
+    void TestRoundTrip() {
+        Utils::FrameDecoder decoder;
+        std::string large(200000, 'x');
+        std::string stream = Utils::EncodeFrame("1") + Utils::EncodeFrame("") + Utils::EncodeFrame(large);
+        decoder.Feed(stream.data(), stream.size());
+
+        std::string frame;
+        assert(decoder.Next(frame) && frame == "1" && "First frame should decode");
+        assert(decoder.Next(frame) && frame.empty() && "Empty frame should decode");
+        assert(decoder.Next(frame) && frame == large && "Large frame should decode intact");
+        assert(!decoder.Next(frame) && decoder.Buffered() == 0 && "Stream should be fully consumed");
+        std::cout << "Frame round trip test passed\n";
+    }
+
+    void TestSplitReads() {
+        Utils::FrameDecoder decoder;
+        std::string stream;
+        Utils::AppendFrame(stream, "Enter email:");
+        Utils::AppendFrame(stream, "Enter password:");
+
+        // Feed one byte at a time, as a slow socket might deliver it.
+        std::string frame;
+        int decoded = 0;
+        for (char byte : stream) {
+            decoder.Feed(&byte, 1);
+            while (decoder.Next(frame)) {
+                assert(frame == (decoded == 0 ? "Enter email:" : "Enter password:") && "Frames out of order");
+                decoded++;
+            }
+        }
+        assert(decoded == 2 && "Both frames should decode from split reads");
+        std::cout << "Split reads test passed\n";
+    }
+
+    void TestOversizedFrame() {
+        Utils::FrameDecoder decoder;
+        const char header[] = {'\x7f', '\x00', '\x00', '\x00'};
+        decoder.Feed(header, sizeof(header));
+
+        std::string frame;
+        assert(!decoder.Next(frame) && decoder.Failed() && "Oversized frame should fail the stream");
+        std::cout << "Oversized frame test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running framing tests...\n";
+        TestRoundTrip();
+        TestSplitReads();
+        TestOversizedFrame();
+        std::cout << "All framing tests passed!\n";
+    }
+};
+
+#endif
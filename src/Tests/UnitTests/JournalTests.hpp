@@ -0,0 +1,229 @@
+#ifndef JOURNAL_TESTS_HPP
+#define JOURNAL_TESTS_HPP
+
+#include <cassert>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "../../Interfaces/LibraryJournal.hpp"
+
+namespace fs = std::filesystem;
+
+class JournalTests {
+private:
+    const std::string TEST_DIR = "./resources/test/database";
+    const std::string BOOKS_FILE = TEST_DIR + "/test_journal_books.json";
+    const std::string USERS_FILE = TEST_DIR + "/test_journal_users.json";
+    const std::string TRANSACTIONS_FILE = TEST_DIR + "/test_journal_transactions.json";
+    const std::string JOURNAL_FILE = TEST_DIR + "/test_library.journal";
+    const std::string CRASH_SUFFIX = ".crash";
+
+    std::vector<std::string> Files() const {
+        return {BOOKS_FILE, USERS_FILE, TRANSACTIONS_FILE, JOURNAL_FILE};
+    }
+
+    void SetUp() {
+        fs::create_directories(TEST_DIR);
+        for (const auto& path : {BOOKS_FILE, USERS_FILE, TRANSACTIONS_FILE}) {
+            std::ofstream file(path);
+            file << "[]";
+            file.close();
+            fs::remove(path + ".seq");
+        }
+        fs::remove(JOURNAL_FILE);
+
+        Books books(BOOKS_FILE);
+        BooksDto book{};
+        book.Name = "Journal Book";
+        book.Isbn = "978-0000000001";
+        book.Author = "Author";
+        book.Publisher = "Publisher";
+        book.NoOfCopies = 1;
+        book.Status = BookStatus::BookStatus_ACTIVE;
+        assert(books.AddBook(book) && "Seeding a book failed");
+
+        Users users(USERS_FILE);
+        UserDto user{};
+        user.FirstName = "Jane";
+        user.LastName = "Doe";
+        user.Email = "jane.journal@test.com";
+        user.PasswordHash = "password123";
+        user.Type = UserType::UserType_USERS;
+        user.Status = UserStatus::UserStatus_ACTIVE;
+        assert(users.AddUser(user) == "success" && "Seeding a user failed");
+    }
+
+    void TearDown() {
+        for (const auto& path : Files()) {
+            fs::remove(path);
+            fs::remove(path + ".seq");
+            fs::remove(path + CRASH_SUFFIX);
+        }
+    }
+
+    UnitOfWork Borrow(int userId, int bookId) {
+        TransactionsDto transaction{};
+        transaction.UserId = userId;
+        transaction.BookId = bookId;
+        transaction.Status = BorrowStatus::BorrowStatus_BORROWED;
+
+        UnitOfWork work;
+        work.AddTransaction(transaction);
+        work.ReserveCopy(bookId);
+        return work;
+    }
+
+    void TestCommitAppliesEveryStore() {
+        Books books(BOOKS_FILE);
+        Users users(USERS_FILE);
+        Transactions transactions(TRANSACTIONS_FILE);
+        LibraryJournal journal(JOURNAL_FILE, books, users, transactions);
+
+        auto work = Borrow(1, 1);
+        assert(journal.Commit(work) && "Commit failed");
+        assert(work.AddedTransactionIds().size() == 1 && "The new transaction should get an id");
+        assert(journal.PendingRecords() == 1 && "A commit should be one journal record");
+
+        auto transaction = transactions.GetTransactionById(work.AddedTransactionIds()[0]);
+        assert(transaction.UserId == 1 && transaction.BookId == 1 && transaction.DueDate > 0 &&
+               "The transaction should be stored with its loan dates");
+        assert(books.GetBooksById(1).NoOfCopies == 0 && "The copy count should drop");
+        assert(transactions.CountTransactionsByUserAndStatus(1, BorrowStatus::BorrowStatus_BORROWED) == 1 &&
+               "The loan should count against the user");
+
+        std::ifstream file(BOOKS_FILE);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        assert(contents.find("\"NoOfCopies\": 1") != std::string::npos &&
+               "Store files should only change at checkpoint");
+        std::cout << "Commit test passed\n";
+    }
+
+    void TestRejectedChangeWritesNothing() {
+        Books books(BOOKS_FILE);
+        Users users(USERS_FILE);
+        Transactions transactions(TRANSACTIONS_FILE);
+        LibraryJournal journal(JOURNAL_FILE, books, users, transactions);
+
+        auto work = Borrow(1, 1);
+        assert(!journal.Commit(work) && "Borrowing with no copies left should fail");
+        assert(work.OutOfStock() && work.AddedTransactionIds().empty() && "The failure should be reported");
+        assert(journal.PendingRecords() == 0 && "A rejected unit should not be journaled");
+        assert(transactions.GetAllTransactions().size() == 1 && "No transaction should be added");
+        assert(transactions.CountTransactionsByUserAndStatus(1, BorrowStatus::BorrowStatus_BORROWED) == 1 &&
+               "The user's loans should be untouched");
+
+        auto missing = Borrow(1, 99);
+        assert(!journal.Commit(missing) && !missing.OutOfStock() && "A missing row should abort the unit");
+        std::cout << "Rejected change test passed\n";
+    }
+
+    void TestReplayAfterCrash() {
+        {
+            Books books(BOOKS_FILE);
+            Users users(USERS_FILE);
+            Transactions transactions(TRANSACTIONS_FILE);
+            LibraryJournal journal(JOURNAL_FILE, books, users, transactions);
+
+            UnitOfWork work;
+            work.UpdateBook(1, [](BooksDto& row) { row.NoOfCopies += 5; return true; });
+            work.UpdateUser(1, [](UserDto& row) { row.Address = "Replayed"; return true; });
+            assert(journal.Commit(work) && "Commit failed");
+
+            // Keep the files as a crash right after the commit would leave them.
+            for (const auto& path : Files()) {
+                fs::copy_file(path, path + CRASH_SUFFIX, fs::copy_options::overwrite_existing);
+            }
+        }
+        for (const auto& path : Files()) {
+            fs::rename(path + CRASH_SUFFIX, path);
+        }
+
+        {
+            Books books(BOOKS_FILE);
+            Users users(USERS_FILE);
+            Transactions transactions(TRANSACTIONS_FILE);
+            assert(books.GetBooksById(1).NoOfCopies == 0 && "The store file should predate the commit");
+
+            LibraryJournal journal(JOURNAL_FILE, books, users, transactions);
+            assert(books.GetBooksById(1).NoOfCopies == 5 && "Replay should restore the book");
+            assert(users.GetUserById(1).Address == "Replayed" && "Replay should restore the user");
+            assert(journal.PendingRecords() == 0 && "Replayed records should be checkpointed");
+        }
+
+        Books books(BOOKS_FILE);
+        assert(books.GetBooksById(1).NoOfCopies == 5 && "The checkpoint should reach the store file");
+        std::cout << "Replay test passed\n";
+    }
+
+    void TestConcurrentBorrowsNeverOversell() {
+        Books books(BOOKS_FILE);
+        Users users(USERS_FILE);
+        Transactions transactions(TRANSACTIONS_FILE);
+        LibraryJournal journal(JOURNAL_FILE, books, users, transactions);
+        int available = books.GetBooksById(1).NoOfCopies;
+        size_t loansBefore = transactions.GetAllTransactions().size();
+
+        std::atomic<int> borrowed{0};
+        std::vector<std::thread> borrowers;
+        for (int i = 0; i < 8; i++) {
+            borrowers.emplace_back([this, &journal, &borrowed]() {
+                for (int attempt = 0; attempt < 2; attempt++) {
+                    auto work = Borrow(1, 1);
+                    if (journal.Commit(work)) borrowed++;
+                }
+            });
+        }
+        for (auto& borrower : borrowers) borrower.join();
+
+        assert(borrowed == available && "Exactly the available copies should be lent");
+        assert(books.GetBooksById(1).NoOfCopies == 0 && "The copy count should never go negative");
+        assert(transactions.GetAllTransactions().size() == loansBefore + available &&
+               "Only successful borrows should leave a loan");
+        std::cout << "Concurrent borrow test passed\n";
+    }
+
+    void TestSingleStoreWritesCheckpoint() {
+        Books books(BOOKS_FILE);
+        Users users(USERS_FILE);
+        Transactions transactions(TRANSACTIONS_FILE);
+        LibraryJournal journal(JOURNAL_FILE, books, users, transactions, 2);
+
+        for (const char* isbn : {"978-0000000002", "978-0000000003"}) {
+            BooksDto book{};
+            book.Name = "Checkpointed Book";
+            book.Isbn = isbn;
+            book.Author = "Author";
+            book.Publisher = "Publisher";
+            book.NoOfCopies = 1;
+            book.Status = BookStatus::BookStatus_ACTIVE;
+            assert(books.AddBook(book) && "Adding a book through the journal failed");
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (journal.PendingRecords() > 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        assert(journal.PendingRecords() == 0 && "Single-store writes should trigger a checkpoint too");
+
+        std::ifstream file(BOOKS_FILE);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        assert(contents.find("978-0000000003") != std::string::npos && "The checkpoint should reach the store file");
+        std::cout << "Single-store checkpoint test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running journal tests...\n";
+        SetUp();
+        TestCommitAppliesEveryStore();
+        TestRejectedChangeWritesNothing();
+        TestReplayAfterCrash();
+        TestConcurrentBorrowsNeverOversell();
+        TestSingleStoreWritesCheckpoint();
+        TearDown();
+        std::cout << "All journal tests passed!\n";
+    }
+};
+
+#endif
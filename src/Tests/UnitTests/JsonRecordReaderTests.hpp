@@ -0,0 +1,129 @@
+#ifndef JSON_RECORD_READER_TESTS_HPP
+#define JSON_RECORD_READER_TESTS_HPP
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../../Utils/JsonRecordReader.hpp"
+
+class JsonRecordReaderTests {
+private:
+    struct Part {
+        int PartId;
+        std::string Label;
+    };
+
+    struct Record {
+        int Id;
+        std::string Name;
+        std::vector<std::string> Tags;
+        std::vector<Part> Parts;
+    };
+
+    struct RecordDecoder {
+        using Record = JsonRecordReaderTests::Record;
+
+        static void Set(Record& record, const std::string& field, const std::string& member,
+                        const Utils::JsonValue& value) {
+            if (field == "Parts") {
+                if (record.Parts.empty()) return;
+                if (member == "PartId") record.Parts.back().PartId = value.Int();
+                else if (member == "Label") record.Parts.back().Label = value.TakeString();
+                return;
+            }
+            if (field == "Id") record.Id = value.Int();
+            else if (field == "Name") record.Name = value.TakeString();
+            else if (field == "Tags") record.Tags.push_back(value.TakeString());
+        }
+        static void BeginElement(Record& record, const std::string& field) {
+            if (field == "Parts") record.Parts.push_back(Part{});
+        }
+        static void Finish(Record&) {}
+    };
+
+    const std::string SAMPLE =
+        "[\n"
+        "  {\"Id\": 1, \"Name\": \"first\", \"Tags\": [\"a\", \"b\"],\n"
+        "   \"Parts\": [{\"PartId\": 10, \"Label\": \"x\"}, {\"PartId\": 11, \"Label\": \"y\"}],\n"
+        "   \"Extra\": {\"Nested\": [1, 2, {\"Deep\": true}]}},\n"
+        "  {\"Name\": \"second\", \"Id\": 2, \"Tags\": [], \"Parts\": []},\n"
+        "  {\"Id\": 3, \"Name\": \"third\"}\n"
+        "]\n";
+
+    std::vector<Record> ReadAll(const Utils::JsonRecordFilter* filter = nullptr) {
+        std::istringstream in(SAMPLE);
+        std::vector<Record> records;
+        Utils::ForEachJsonRecord<RecordDecoder>(in, [&records](Record& record) {
+            records.push_back(std::move(record));
+            return true;
+        }, filter);
+        return records;
+    }
+
+    void TestDecodesNestedFields() {
+        auto records = ReadAll();
+        assert(records.size() == 3 && "Every record should be decoded");
+        assert(records[0].Id == 1 && records[0].Name == "first" && "Scalars should decode");
+        assert(records[0].Tags == std::vector<std::string>({"a", "b"}) && "String arrays should decode");
+        assert(records[0].Parts.size() == 2 && records[0].Parts[1].PartId == 11 &&
+               records[0].Parts[1].Label == "y" && "Objects inside arrays should decode");
+        assert(records[1].Id == 2 && records[1].Name == "second" && records[1].Parts.empty() &&
+               "Field order should not matter");
+        assert(records[2].Tags.empty() && "Missing fields should stay value-initialized");
+        std::cout << "Nested fields test passed\n";
+    }
+
+    void TestFilterSkipsRecords() {
+        Utils::JsonRecordFilter filter{"Id", [](const Utils::JsonValue& value) { return value.Int() != 1; }};
+        auto records = ReadAll(&filter);
+        assert(records.size() == 2 && records[0].Id == 2 && records[1].Id == 3 &&
+               "Rejected records should never reach the visitor");
+
+        Utils::JsonRecordFilter missing{"Owner", [](const Utils::JsonValue&) { return true; }};
+        assert(ReadAll(&missing).empty() && "Records without the filtered field should be skipped");
+        std::cout << "Filter test passed\n";
+    }
+
+    void TestVisitorStopsEarly() {
+        std::istringstream in(SAMPLE);
+        int visited = 0;
+        Utils::ForEachJsonRecord<RecordDecoder>(in, [&visited](Record&) {
+            visited++;
+            return false;
+        });
+        assert(visited == 1 && "Returning false should stop the scan without an error");
+        std::cout << "Early stop test passed\n";
+    }
+
+    void TestMalformedInput() {
+        std::istringstream in("[{\"Id\": 1}, {\"Id\": ");
+        bool threw = false;
+        try {
+            Utils::ForEachJsonRecord<RecordDecoder>(in, [](Record&) { return true; });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && "Truncated input should throw");
+
+        Record record{};
+        assert(Utils::ParseJsonRecord<RecordDecoder>("{\"Id\": 7, \"Name\": \"row\"}", record) &&
+               record.Id == 7 && record.Name == "row" && "A single JSON Lines row should decode");
+        assert(!Utils::ParseJsonRecord<RecordDecoder>("{\"Id\": 7", record) && "A torn row should be rejected");
+        std::cout << "Malformed input test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running JSON record reader tests...\n";
+        TestDecodesNestedFields();
+        TestFilterSkipsRecords();
+        TestVisitorStopsEarly();
+        TestMalformedInput();
+        std::cout << "All JSON record reader tests passed!\n";
+    }
+};
+
+#endif
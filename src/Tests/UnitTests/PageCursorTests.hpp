@@ -0,0 +1,53 @@
+#ifndef PAGE_CURSOR_TESTS_HPP
+#define PAGE_CURSOR_TESTS_HPP
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include "../../Utils/PageCursor.hpp"
+
+class PageCursorTests {
+private:
+    void TestRoundTrip() {
+        std::vector<uint64_t> key;
+        std::string cursor = Utils::EncodeCursor({0, 42, UINT64_MAX});
+        assert(Utils::DecodeCursor(cursor, 3, key) && "A cursor should decode");
+        assert(key == std::vector<uint64_t>({0, 42, UINT64_MAX}) && "Every key field should survive");
+        assert(!Utils::DecodeCursor(cursor, 2, key) && "The field count should be checked");
+        std::cout << "Cursor round trip test passed\n";
+    }
+
+    void TestMalformedCursors() {
+        std::vector<uint64_t> key;
+        for (std::string cursor : {"", "c", "x2a", "c2a.", "c.2a", "c2g", "c10000000000000000"}) {
+            assert(!Utils::DecodeCursor(cursor, 1, key) && "A malformed cursor should be rejected");
+        }
+        std::cout << "Malformed cursor test passed\n";
+    }
+
+    void TestParsePageRequest() {
+        auto page = Utils::ParsePageRequest("17");
+        assert(page.cursor.empty() && page.pageSize == Utils::DefaultPageSize && "Defaults without arguments");
+
+        page = Utils::ParsePageRequest("17 c2a 5");
+        assert(page.cursor == "c2a" && page.pageSize == 5 && "Cursor and page size should be read");
+
+        page = Utils::ParsePageRequest("4 100000 c1");
+        assert(page.cursor == "c1" && page.pageSize == Utils::DefaultPageSize && "Oversized sizes are ignored");
+
+        page = Utils::ParsePageRequest("4 500");
+        assert(page.pageSize == Utils::MaxPageSize && "Page size should be capped");
+        std::cout << "Page request parsing test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running page cursor tests...\n";
+        TestRoundTrip();
+        TestMalformedCursors();
+        TestParsePageRequest();
+        std::cout << "All page cursor tests passed!\n";
+    }
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef RESPONSE_BUFFER_TESTS_HPP
+#define RESPONSE_BUFFER_TESTS_HPP
+
+#include <cassert>
+#include <climits>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../Utils/ResponseBuffer.hpp"
+
+class ResponseBufferTests {
+private:
+    static std::string Reference(std::time_t time) {
+        std::tm parts{};
+        gmtime_r(&time, &parts);
+        char text[64];
+        std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S UTC", &parts);
+        return text;
+    }
+
+    void TestUtcMatchesGmtime() {
+        std::vector<std::time_t> times = {0, -1, 86399, 86400, 951782400, 951868799, 4107542400,
+                                          1700000000, std::time(nullptr)};
+        // A walk across several years hits month ends and leap days.
+        for (std::time_t t = 946684800; t < 1104537600; t += 86400 * 7 + 3601) times.push_back(t);
+
+        for (std::time_t t : times) {
+            ResponseBuffer out;
+            out << Utils::Utc{t};
+            assert(std::string(out.Payload()) == Reference(t) && "UTC formatting should match gmtime");
+        }
+        std::cout << "UTC formatting test passed\n";
+    }
+
+    void TestUtcAcrossThreads() {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([i]() {
+                for (std::time_t t = 1600000000 + i * 977; t < 1600000000 + 400 * 86400; t += 86400 / 3) {
+                    char text[Utils::UtcTimestampSize];
+                    Utils::FormatUtc(t, text);
+                    assert(std::string(text, sizeof(text)) == Reference(t) &&
+                           "Each thread's cached date should stay its own");
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        std::cout << "UTC formatting thread test passed\n";
+    }
+
+    void TestFramedReply() {
+        ResponseBuffer out;
+        out << "ID: " << 42 << ", Copies: " << -3 << ", Size: " << size_t(7) << ',' << ' ' << LLONG_MIN;
+        std::string expected = "ID: 42, Copies: -3, Size: 7, " + std::to_string(LLONG_MIN);
+        assert(std::string(out.Payload()) == expected && "Values should render as text");
+
+        const std::string& frame = out.Frame();
+        assert(frame == Utils::EncodeFrame(expected) && "The buffer should already be a wire frame");
+
+        out.Clear();
+        assert(out.Payload().empty() && out.Frame() == Utils::EncodeFrame("") && "Clear should empty the payload");
+        std::cout << "Framed reply test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running response buffer tests...\n";
+        TestUtcMatchesGmtime();
+        TestUtcAcrossThreads();
+        TestFramedReply();
+        std::cout << "All response buffer tests passed!\n";
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SESSION_STORE_TESTS_HPP
+#define SESSION_STORE_TESTS_HPP
+
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../../Utils/SessionStore.hpp"
+
+class SessionStoreTests {
+private:
+    struct Counter {
+        int value = 0;
+    };
+
+    void TestAcquireAndErase() {
+        SessionStore<Counter> store;
+        {
+            auto handle = store.Acquire(7);
+            handle->value = 3;
+        }
+        assert(store.Size() == 1 && "Acquire should create the session");
+        assert(store.Acquire(7)->value == 3 && "Session state should persist between acquires");
+
+        store.Erase(7);
+        assert(store.Size() == 0 && "Erase should drop the session");
+        assert(store.Acquire(7)->value == 0 && "A new session should start empty");
+        std::cout << "Acquire and erase test passed\n";
+    }
+
+    void TestConcurrentClients() {
+        SessionStore<Counter> store;
+        const int clients = 8;
+        const int commands = 2000;
+
+        // Two threads per client race on the same session; the session lock
+        // must keep every increment.
+        std::vector<std::thread> threads;
+        for (int t = 0; t < clients * 2; t++) {
+            threads.emplace_back([&store, t, commands]{
+                for (int i = 0; i < commands; i++) {
+                    auto handle = store.Acquire(t / 2);
+                    handle->value++;
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        for (int c = 0; c < clients; c++) {
+            assert(store.Acquire(c)->value == commands * 2 && "Concurrent increments were lost");
+        }
+        std::cout << "Concurrent clients test passed\n";
+    }
+
+    void TestEvictIdle() {
+        SessionStore<Counter> store;
+        store.Acquire(1)->value = 1;
+        store.Acquire(2)->value = 2;
+
+        assert(store.EvictIdle(std::chrono::seconds(60)) == 0 && "Fresh sessions should not be evicted");
+        {
+            auto busy = store.Acquire(2);
+            assert(store.EvictIdle(std::chrono::seconds(0)) == 1 && "Only the idle session should be evicted");
+        }
+        assert(store.Size() == 1 && "The session in use should survive eviction");
+        std::cout << "Idle eviction test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running session store tests...\n";
+        TestAcquireAndErase();
+        TestConcurrentClients();
+        TestEvictIdle();
+        std::cout << "All session store tests passed!\n";
+    }
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef STORE_FILE_TESTS_HPP
+#define STORE_FILE_TESTS_HPP
+
+#include <cassert>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <set>
+#include <vector>
+#include <mutex>
+#include "../../Utils/StoreFile.hpp"
+#include "../../Utils/IdSequence.hpp"
+
+namespace fs = std::filesystem;
+
+class StoreFileTests {
+private:
+    const std::string TEST_DIR = "./resources/test/database";
+    const std::string TEST_FILE = TEST_DIR + "/test_store_file.json";
+
+    void SetUp() {
+        fs::create_directories(TEST_DIR);
+        TearDown();
+    }
+
+    void TearDown() {
+        fs::remove(TEST_FILE);
+        fs::remove(TEST_FILE + ".tmp");
+        fs::remove(TEST_FILE + ".lock");
+        fs::remove(TEST_FILE + ".seq");
+    }
+
+    void TestReplaceAndRead() {
+        auto file = StoreFile::For(TEST_FILE);
+        assert(file == StoreFile::For(TEST_FILE) && "Instances on one path should share descriptors");
+        assert(file->Read().empty() && "A missing file should read as empty");
+        {
+            StoreFile::Lock lock(*file);
+            file->Replace("[1]\n");
+            file->Replace("[1, 2]\n");
+        }
+        assert(file->Read() == "[1, 2]\n" && "Read should return the latest contents");
+        assert(!fs::exists(TEST_FILE + ".tmp") && "The temp file should be renamed away");
+
+        // Another process replacing the file is noticed on the next read.
+        std::string outside = TEST_FILE + ".outside";
+        std::ofstream(outside) << "[3]";
+        fs::rename(outside, TEST_FILE);
+        assert(file->Read() == "[3]" && "An outside replacement should be picked up");
+        std::cout << "Replace and read test passed\n";
+    }
+
+    void TestReadersNeverSeePartialFiles() {
+        auto file = StoreFile::For(TEST_FILE);
+        const size_t size = 256 * 1024;
+        {
+            StoreFile::Lock lock(*file);
+            file->Replace(std::string(size, 'a'));
+        }
+
+        std::atomic<bool> done{false};
+        std::thread writer([&]() {
+            for (int i = 0; i < 20; i++) {
+                StoreFile::Lock lock(*file);
+                file->Replace(std::string(size, i % 2 == 0 ? 'b' : 'a'));
+            }
+            done = true;
+        });
+
+        size_t reads = 0;
+        while (!done) {
+            std::string contents = file->Read();
+            assert(contents.size() == size && "A reader should never see a truncated file");
+            assert(contents.find_first_not_of(contents[0]) == std::string::npos &&
+                   "A reader should never see two versions mixed");
+            reads++;
+        }
+        writer.join();
+        std::cout << "Partial file test passed (" << reads << " reads)\n";
+    }
+
+    void TestIdSequenceAcrossInstances() {
+        // Two instances on one sidecar stand in for two processes sharing a store.
+        IdSequence first(TEST_FILE + ".seq");
+        IdSequence second(TEST_FILE + ".seq");
+        first.EnsureAtLeast(10);
+
+        std::mutex idsMutex;
+        std::set<int> ids;
+        std::vector<std::thread> allocators;
+        for (IdSequence* sequence : {&first, &second, &first, &second}) {
+            allocators.emplace_back([sequence, &idsMutex, &ids]() {
+                for (int i = 0; i < 50; i++) {
+                    int id = sequence->Next();
+                    std::lock_guard<std::mutex> lock(idsMutex);
+                    ids.insert(id);
+                }
+            });
+        }
+        for (auto& allocator : allocators) allocator.join();
+        assert(ids.size() == 200 && *ids.begin() == 10 && *ids.rbegin() == 209 &&
+               "Instances sharing a sidecar should never hand out an id twice");
+        assert(IdSequence(TEST_FILE + ".seq").Next() == 210 && "The sidecar should hold the next id");
+        std::cout << "Id sequence test passed\n";
+    }
+
+public:
+    void RunAllTests() {
+        std::cout << "Running store file tests...\n";
+        SetUp();
+        TestReplaceAndRead();
+        TestReadersNeverSeePartialFiles();
+        TestIdSequenceAcrossInstances();
+        TearDown();
+        std::cout << "All store file tests passed!\n";
+    }
+};
+
+#endif
@@ -3,7 +3,11 @@
 
 #include <cassert>
 #include <filesystem>
+#include <csignal>
+#include <sys/resource.h>
+#include <nlohmann/json.hpp>
 #include "../../Interfaces/Transactions.hpp"
+#include "../../Utils/WriteAheadLog.hpp"
 
 namespace fs = std::filesystem;
 
@@ -17,6 +21,7 @@ private:
         std::ofstream file(TEST_FILE);
         file << "[]";
         file.close();
+        fs::remove(TEST_FILE + ".seq");
         std::cout << "Test file created at: " << TEST_FILE << std::endl;
     }
 
@@ -104,6 +109,316 @@ private:
         std::cout << "User and book queries test passed\n";
     }
 
+    void TestIndexesTrackChanges() {
+        Transactions transactions(TEST_FILE);
+
+        TransactionsDto loan{};
+        loan.UserId = 42;
+        loan.BookId = 7;
+        loan.Status = BorrowStatus::BorrowStatus_BORROWED;
+        assert(transactions.AddTransaction(loan) == "success" && "Add transaction failed");
+
+        auto borrowed = transactions.GetBorrowedTransactionsByUserAndBookId(42, 7);
+        assert(borrowed.TransactionId != 0 && "Active loan should be found by user and book");
+
+        borrowed.Status = BorrowStatus::BorrowStatus_RETURNED;
+        transactions.UpdateTransaction(borrowed);
+        assert(transactions.GetBorrowedTransactionsByUserAndBookId(42, 7).TransactionId == 0 &&
+               "Returned loan should leave the borrowed index");
+        assert(transactions.GetReturnedTransactionsByUserAndBookId(42, 7).TransactionId == borrowed.TransactionId &&
+               "Returned loan should enter the returned index");
+
+        borrowed.BookId = 8;
+        transactions.UpdateTransaction(borrowed);
+        assert(transactions.GetTransactionsByBookId(7).empty() && transactions.GetTransactionsByBookId(8).size() == 1 &&
+               "Moving a transaction to another book should re-file it");
+        assert(transactions.GetReturnedTransactionsByUserAndBookId(42, 8).TransactionId == borrowed.TransactionId &&
+               "The composite key should follow the book change");
+
+        transactions.RemoveTransaction(borrowed.TransactionId);
+        assert(transactions.GetTransactionsByUserId(42).empty() && "Removed transaction should leave the user index");
+        assert(transactions.GetTransactionsByBookId(8).empty() && "Removed transaction should leave the book index");
+
+        std::cout << "Index maintenance test passed\n";
+    }
+
+    void TestUserStatusViews() {
+        Transactions transactions(TEST_FILE);
+
+        std::vector<int> ids;
+        for (int bookId = 1; bookId <= 3; bookId++) {
+            TransactionsDto loan{};
+            loan.UserId = 43;
+            loan.BookId = bookId;
+            loan.Status = BorrowStatus::BorrowStatus_BORROWED;
+            assert(transactions.AddTransaction(loan) == "success" && "Add transaction failed");
+            ids.push_back(transactions.GetBorrowedTransactionsByUserAndBookId(43, bookId).TransactionId);
+        }
+        auto returned = transactions.GetTransactionById(ids[1]);
+        returned.Status = BorrowStatus::BorrowStatus_RETURNED;
+        transactions.UpdateTransaction(returned);
+
+        auto borrowed = transactions.GetTransactionsByUserAndStatus(43, BorrowStatus::BorrowStatus_BORROWED);
+        assert(borrowed.size() == 2 && borrowed[0].TransactionId == ids[0] && borrowed[1].TransactionId == ids[2] &&
+               "Borrowed view should list the open loans in id order");
+        assert(transactions.CountTransactionsByUserAndStatus(43, BorrowStatus::BorrowStatus_BORROWED) == 2 &&
+               "Borrowed count should match the view");
+        assert(transactions.CountTransactionsByUserAndStatus(43, BorrowStatus::BorrowStatus_RETURNED) == 1 &&
+               "Returned count should follow the status change");
+
+        transactions.RemoveTransaction(ids[0]);
+        assert(transactions.CountTransactionsByUserAndStatus(43, BorrowStatus::BorrowStatus_BORROWED) == 1 &&
+               "Removing a loan should drop the count");
+        auto page = transactions.GetTransactionsByUserAndStatus(43, BorrowStatus::BorrowStatus_BORROWED, 0, 1);
+        assert(page.size() == 1 && page[0].TransactionId == ids[2] && "A limited view should keep the lowest ids");
+
+        for (int id : {ids[1], ids[2]}) transactions.RemoveTransaction(id);
+        assert(transactions.GetTransactionsByUserAndStatus(43, BorrowStatus::BorrowStatus_RETURNED).empty() &&
+               "No returned loans should remain");
+
+        std::cout << "User status view test passed\n";
+    }
+
+    void TestLedgerPages() {
+        Transactions transactions(TEST_FILE);
+        auto all = transactions.GetAllTransactions();
+
+        std::vector<int> paged;
+        int afterId = 0;
+        while (true) {
+            auto page = transactions.GetTransactionsPage(afterId, 2);
+            if (page.empty()) break;
+            assert(page.size() <= 2 && "A page should respect its size");
+            for (const auto& transaction : page) paged.push_back(transaction.TransactionId);
+            afterId = page.back().TransactionId;
+        }
+        assert(paged.size() == all.size() && "Pages should cover the whole ledger");
+        for (size_t i = 0; i < all.size(); i++) {
+            assert(paged[i] == all[i].TransactionId && "Pages should come in id order without repeats");
+        }
+        std::cout << "Ledger page test passed\n";
+    }
+
+    void TestDateIndexRanges() {
+        Transactions transactions(TEST_FILE);
+        const std::time_t base = 1000000;
+
+        // Three loans for one patron due on consecutive days, added out of order.
+        for (int day : {2, 0, 1}) {
+            TransactionsDto loan{};
+            loan.UserId = 77;
+            loan.BookId = 100 + day;
+            loan.Status = BorrowStatus::BorrowStatus_BORROWED;
+            assert(transactions.AddTransaction(loan) == "success" && "Add transaction failed");
+            auto added = transactions.GetBorrowedTransactionsByUserAndBookId(77, 100 + day);
+            added.DueDate = base + day * 86400;
+            transactions.UpdateTransaction(added);
+        }
+
+        auto due = transactions.GetTransactionsByDueDateAndUserId(base, base + 86400, 77);
+        assert(due.size() == 2 && "Range should include both boundaries");
+        assert(due[0].BookId == 100 && due[1].BookId == 101 && "Range results should be ordered by date");
+
+        auto overdue = transactions.GetTransactionsByDueDate(0, base + 2 * 86400);
+        assert(overdue.size() == 3 && "Moved due dates should be re-indexed");
+        assert(transactions.GetTransactionsByDueDate(base + 1, base + 86400 - 1).empty() &&
+               "Empty range should return nothing");
+
+        for (const auto& loan : overdue) {
+            transactions.RemoveTransaction(loan.TransactionId);
+        }
+        assert(transactions.GetTransactionsByDueDateAndUserId(0, base * 2, 77).empty() &&
+               "Removed loans should leave the date index");
+        std::cout << "Date index ranges test passed\n";
+    }
+
+    void TestWriteAheadLog() {
+        const std::string walFile = TEST_DIR + "/test_transactions_wal.json";
+        {
+            std::ofstream file(walFile);
+            file << "[]";
+        }
+        fs::remove(walFile + ".wal");
+        fs::remove(walFile + ".seq");
+
+        {
+            Transactions transactions(walFile, StorageMode::WRITE_AHEAD_LOG);
+            TransactionsDto transaction{};
+            transaction.UserId = 7;
+            transaction.BookId = 3;
+            transaction.Status = BorrowStatus::BorrowStatus_BORROWED;
+            assert(transactions.AddTransaction(transaction) == "success" && "Logged add failed");
+            assert(transactions.AddTransaction(transaction) == "success" && "Logged add failed");
+
+            auto saved = transactions.GetTransactionById(2);
+            saved.Status = BorrowStatus::BorrowStatus_RETURNED;
+            assert(transactions.UpdateTransaction(saved) == "success" && "Logged update failed");
+        }
+
+        // Reopening replays the log on top of the still-empty snapshot
+        {
+            Transactions transactions(walFile, StorageMode::WRITE_AHEAD_LOG);
+            assert(transactions.GetAllTransactions().size() == 2 && "Log replay lost records");
+            assert(transactions.GetTransactionById(2).Status == BorrowStatus::BorrowStatus_RETURNED &&
+                   "Log replay lost update");
+
+            assert(transactions.Compact() && "Compaction failed");
+            assert(fs::file_size(walFile + ".wal") == 0 && "Compaction should truncate the log");
+        }
+
+        Transactions snapshot(walFile);
+        assert(snapshot.GetAllTransactions().size() == 2 && "Compacted snapshot missing records");
+
+        fs::remove(walFile);
+        fs::remove(walFile + ".wal");
+        fs::remove(walFile + ".seq");
+        std::cout << "Write-ahead log test passed\n";
+    }
+
+    void TestFailedAppendLeavesNoTornLine() {
+        const std::string logFile = TEST_DIR + "/test_torn.wal";
+        fs::remove(logFile);
+        {
+            WriteAheadLog log(logFile, 1);
+            assert(log.Append("{\"id\":1}") && "First append failed");
+            auto size = fs::file_size(logFile);
+
+            // Let only part of the next record reach the file, as a full disk would.
+            rlimit previous;
+            getrlimit(RLIMIT_FSIZE, &previous);
+            auto previousHandler = std::signal(SIGXFSZ, SIG_IGN);
+            rlimit limit = previous;
+            limit.rlim_cur = size + 4;
+            setrlimit(RLIMIT_FSIZE, &limit);
+            bool appended = log.Append("{\"id\":2,\"padding\":\"xxxxxxxxxxxxxxxx\"}");
+            setrlimit(RLIMIT_FSIZE, &previous);
+            std::signal(SIGXFSZ, previousHandler);
+
+            assert(!appended && "A short write should fail the append");
+            assert(fs::file_size(logFile) == size && "The partial line should be cut off");
+            assert(log.Append("{\"id\":3}") && "Appending after a failure failed");
+        }
+
+        std::vector<std::string> records;
+        WriteAheadLog log(logFile, 1);
+        log.Replay([&records](const std::string& line) { records.push_back(line); });
+        assert(records.size() == 2 && records[1] == "{\"id\":3}" &&
+               "Records acknowledged after a failed append should survive replay");
+        fs::remove(logFile);
+        std::cout << "Failed append test passed\n";
+    }
+
+    void TestCorruptRecordStopsReplay() {
+        const std::string logFile = TEST_DIR + "/test_corrupt.wal";
+        auto parse = [](const std::string& line) { (void)nlohmann::json::parse(line); };
+        {
+            std::ofstream file(logFile);
+            file << "{\"id\":1}\n{\"id\":2}\n{\"id\"";
+        }
+        {
+            WriteAheadLog log(logFile, 1);
+            assert(log.Replay(parse) == 2 && "Complete records should replay");
+        }
+        assert(fs::file_size(logFile) == 18 && "Only the torn last line should be cut off");
+
+        {
+            std::ofstream file(logFile);
+            file << "{\"id\":1}\nnot json\n{\"id\":3}\n";
+        }
+        auto size = fs::file_size(logFile);
+        bool threw = false;
+        try {
+            WriteAheadLog log(logFile, 1);
+            log.Replay(parse);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && "A corrupt record mid-log should fail the replay");
+        assert(fs::file_size(logFile) == size && "Records after the corrupt one should be kept");
+        fs::remove(logFile);
+        std::cout << "Corrupt record test passed\n";
+    }
+
+    void TestSnapshotModeFoldsLeftoverLog() {
+        const std::string walFile = TEST_DIR + "/test_transactions_leftover.json";
+        std::ofstream(walFile) << "[]";
+        fs::remove(walFile + ".wal");
+        fs::remove(walFile + ".seq");
+        {
+            Transactions transactions(walFile, StorageMode::WRITE_AHEAD_LOG);
+            TransactionsDto transaction{};
+            transaction.UserId = 7;
+            transaction.BookId = 3;
+            transaction.Status = BorrowStatus::BorrowStatus_BORROWED;
+            assert(transactions.AddTransaction(transaction) == "success" && "Logged add failed");
+        }
+
+        assert(Transactions(walFile).GetAllTransactions().size() == 1 && "Snapshot mode should fold in the log");
+        assert(fs::file_size(walFile + ".wal") == 0 && "The folded log should be emptied");
+        fs::remove(walFile);
+        fs::remove(walFile + ".wal");
+        fs::remove(walFile + ".seq");
+        fs::remove(walFile + ".lock");
+        std::cout << "Leftover log test passed\n";
+    }
+
+    void TestBinaryStorage() {
+        const std::string binaryFile = TEST_DIR + "/test_transactions.bin";
+        const std::string exportFile = TEST_DIR + "/test_transactions_export.json";
+        fs::remove(binaryFile);
+        fs::remove(binaryFile + ".seq");
+
+        auto expected = Transactions(TEST_FILE).GetAllTransactions();
+        assert(Transactions::ConvertJsonToBinary(TEST_FILE, binaryFile) && "JSON to binary conversion failed");
+
+        int addedId;
+        {
+            Transactions transactions(binaryFile, StorageMode::BINARY);
+            auto loaded = transactions.GetAllTransactions();
+            assert(loaded.size() == expected.size() && "Binary file lost records");
+            for (size_t i = 0; i < loaded.size(); i++) {
+                assert(loaded[i].TransactionId == expected[i].TransactionId &&
+                       loaded[i].DueDate == expected[i].DueDate &&
+                       loaded[i].Status == expected[i].Status && "Binary record differs from JSON");
+            }
+
+            TransactionsDto loan{};
+            loan.UserId = 9;
+            loan.BookId = 4;
+            loan.Status = BorrowStatus::BorrowStatus_BORROWED;
+            assert(transactions.AddTransaction(loan) == "success" && "Binary add failed");
+            auto added = transactions.GetBorrowedTransactionsByUserAndBookId(9, 4);
+            addedId = added.TransactionId;
+
+            added.Status = BorrowStatus::BorrowStatus_RETURNED;
+            assert(transactions.UpdateTransaction(added) == "success" && "Binary update failed");
+            assert(transactions.RemoveTransaction(expected.front().TransactionId) == "success" &&
+                   "Binary remove failed");
+        }
+
+        // Reopen: in-place updates and the freed slot must survive.
+        {
+            Transactions transactions(binaryFile, StorageMode::BINARY);
+            assert(transactions.GetAllTransactions().size() == expected.size() && "Binary reopen lost records");
+            assert(transactions.GetTransactionById(addedId).Status == BorrowStatus::BorrowStatus_RETURNED &&
+                   "Binary update was not written in place");
+            assert(transactions.GetTransactionById(expected.front().TransactionId).TransactionId == 0 &&
+                   "Binary remove did not persist");
+            auto page = transactions.GetTransactionsPage(expected.front().TransactionId - 1, 1);
+            assert(page.size() == 1 && page[0].TransactionId > expected.front().TransactionId &&
+                   "Binary pages should skip freed slots");
+        }
+
+        assert(Transactions::ConvertBinaryToJson(binaryFile, exportFile) && "Binary to JSON conversion failed");
+        Transactions exported(exportFile);
+        assert(exported.GetTransactionById(addedId).UserId == 9 && "Exported JSON missing records");
+
+        for (const auto& path : {binaryFile, binaryFile + ".seq", exportFile, exportFile + ".seq", exportFile + ".lock"}) {
+            fs::remove(path);
+        }
+        std::cout << "Binary storage test passed\n";
+    }
+
 public:
     void RunAllTests() {
         try {
@@ -114,6 +429,15 @@ public:
             TestDateQueries();
             TestStatusQueries();
             TestUserAndBookQueries();
+            TestIndexesTrackChanges();
+            TestUserStatusViews();
+            TestLedgerPages();
+            TestDateIndexRanges();
+            TestWriteAheadLog();
+            TestFailedAppendLeavesNoTornLine();
+            TestCorruptRecordStopsReplay();
+            TestSnapshotModeFoldsLeftoverLog();
+            TestBinaryStorage();
             // TearDown();
             std::cout << "All transaction tests passed!\n";
         }
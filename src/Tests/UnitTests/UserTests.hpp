@@ -3,6 +3,8 @@
 
 #include <cassert>
 #include <filesystem>
+#include <thread>
+#include <atomic>
 #include "../../Interfaces/Users.hpp"
 #include "../../Utils/HashUtils.hpp"
 
@@ -18,6 +20,7 @@ private:
         std::ofstream file(TEST_FILE);
         file << "[]";
         file.close();
+        fs::remove(TEST_FILE + ".seq");
         std::cout << "Test file created at: " << TEST_FILE << std::endl;
     }
 
@@ -40,8 +43,8 @@ private:
         user.CreatedBy = "System";
         
         std::cout << "Adding user with ID: " << user.UserId << std::endl;
-        bool result = users.AddUser(user);
-        assert(result && "Add user failed");
+        std::string result = users.AddUser(user);
+        assert(result == "success" && "Add user failed");
         
         auto savedUser = users.GetUserById(1);
         assert(savedUser.Email == "john.doe@test.com" && "User data mismatch");
@@ -64,8 +67,8 @@ private:
         user.AccessCount = 0;
         
         std::cout << "Adding test user with hash: " << user.PasswordHash << std::endl;
-        bool addResult = users.AddUser(user);
-        assert(addResult && "Failed to add test user");
+        std::string addResult = users.AddUser(user);
+        assert(addResult == "success" && "Failed to add test user");
         
         // Test successful login
         std::cout << "Attempting login...\n";
@@ -86,10 +89,13 @@ private:
         result = users.Login(user.Email, "wrongpass");
         assert(result.find("Account locked") != std::string::npos && "Account should be locked after 5 attempts");
         
-        // Test successful login resets access count
+        // A general update must not clear the count; only the explicit reset does
         auto currentUser = users.GetUserByEmail(user.Email);
         currentUser.AccessCount = 0;
         users.UpdateUser(currentUser);
+        assert(users.Login(user.Email, password).find("Account locked") != std::string::npos &&
+               "Updating the row should not unlock the account");
+        assert(users.ResetFailedLogins(currentUser.UserId) && "Resetting failed logins failed");
         std::cout << "Current users details: " << currentUser.PasswordHash << std::endl;
         result = users.Login(user.Email, password);
         assert(result == "success" && "Login should succeed after reset");
@@ -124,6 +130,15 @@ private:
         Users users(TEST_FILE);
         auto user = users.GetUserById(1);
         assert(user.UserId == 1 && "Get user failed");
+
+        auto batch = users.GetUsersByIds({1, 9999, 1});
+        assert(batch.size() == 1 && batch.at(1).Email == user.Email &&
+               "Batch lookup should resolve each known id once and skip missing ones");
+
+        auto page = users.GetUsersPage(0, 1);
+        assert(page.size() == 1 && page[0].UserId == 1 && "The first page should start at the lowest id");
+        assert(users.GetUsersPage(1, 10).size() == users.GetAllUsers().size() - 1 &&
+               "A page should resume after its cursor");
     }
 
     void TestUpdateUser() {
@@ -139,8 +154,10 @@ private:
 
     void TestUpdatePassword() {
         Users users(TEST_FILE);
-        bool result = users.UpdatePassword(1, "newpassword123");
-        assert(result && "Password update failed");
+        std::string result = users.UpdatePassword(1, "newpassword123");
+        assert(result == "success" && "Password update failed");
+        assert(users.UpdatePassword(9999, "newpassword123") == "User not found" &&
+               "An unknown user should be reported as such");
     }
 
     void TestSoftDelete() {
@@ -152,19 +169,121 @@ private:
         assert(user.Status == UserStatus::UserStatus_DELETED && "User status not updated");
     }
 
-    void TestBookOperations() {
+    void TestEmailIndex() {
         Users users(TEST_FILE);
-        bool result = users.AddBorrowedBook(1, "BOOK-001");
-        assert(result && "Add borrowed book failed");
-        
-        auto borrowed = users.GetBorrowedBooks(1);
-        assert(!borrowed.empty() && borrowed[0] == "BOOK-001" && "Borrowed books mismatch");
-        
-        result = users.AddReturnedBook(1, "BOOK-001");
-        assert(result && "Return book failed");
-        
-        auto returned = users.GetReturnedBooks(1);
-        assert(!returned.empty() && returned[0] == "BOOK-001" && "Returned books mismatch");
+        UserDto user{};
+        user.FirstName = "Mixed";
+        user.LastName = "Case";
+        user.Email = "Mixed.Case@Test.com";
+        user.PasswordHash = "password123";
+        user.Status = UserStatus::UserStatus_ACTIVE;
+        assert(users.AddUser(user) == "success" && "Add user failed");
+
+        UserDto duplicate = user;
+        duplicate.Email = "mixed.case@test.com";
+        assert(users.AddUser(duplicate) == "Email already exists" &&
+               "Email differing only in case should be rejected");
+
+        auto saved = users.GetUserByEmail("MIXED.CASE@TEST.COM");
+        assert(saved.UserId != 0 && saved.Email == "Mixed.Case@Test.com" && "Lookup should ignore case");
+        assert(users.Login("mixed.case@test.com", "password123") == "success" &&
+               "Login should accept any capitalisation of the address");
+
+        saved.Email = "renamed@test.com";
+        assert(users.UpdateUser(saved) && "Update user failed");
+        assert(users.GetUserByEmail("mixed.case@test.com").UserId == 0 && "Old address should leave the index");
+        assert(users.GetUserByEmail("Renamed@Test.com").UserId == saved.UserId && "New address should be indexed");
+
+        Users reloaded(TEST_FILE);
+        assert(reloaded.GetUserByEmail("renamed@test.com").UserId == saved.UserId &&
+               "Index should be rebuilt from the file");
+        assert(reloaded.HardDeleteUser(saved.UserId) && "Hard delete failed");
+        assert(reloaded.GetUserByEmail("renamed@test.com").UserId == 0 && "Deleted user should leave the index");
+        std::cout << "Email index test passed\n";
+    }
+
+    void TestConcurrentLogins() {
+        int userId;
+        {
+            Users users(TEST_FILE);
+            UserDto user{};
+            user.FirstName = "Busy";
+            user.LastName = "User";
+            user.Email = "busy.user@test.com";
+            user.PasswordHash = "password123";
+            user.Status = UserStatus::UserStatus_ACTIVE;
+            assert(users.AddUser(user) == "success" && "Add user failed");
+            userId = users.GetUserByEmail(user.Email).UserId;
+
+            std::atomic<int> signedIn{0};
+            std::vector<std::thread> clients;
+            for (int i = 0; i < 8; i++) {
+                clients.emplace_back([&users, &signedIn]() {
+                    for (int attempt = 0; attempt < 10; attempt++) {
+                        if (users.Login("busy.user@test.com", "password123") == "success") signedIn++;
+                    }
+                });
+            }
+            for (auto& client : clients) client.join();
+            assert(signedIn == 80 && "Concurrent logins should all succeed");
+            assert(users.GetUserById(userId).AccessCount == 0 && "Successful logins should leave no failures");
+
+            std::atomic<int> rejected{0};
+            clients.clear();
+            for (int i = 0; i < 8; i++) {
+                clients.emplace_back([&users, &rejected]() {
+                    for (int attempt = 0; attempt < 3; attempt++) {
+                        if (users.Login("busy.user@test.com", "wrongpass").find("Account locked") != std::string::npos) {
+                            rejected++;
+                        }
+                    }
+                });
+            }
+            for (auto& client : clients) client.join();
+            assert(rejected == 24 - 4 && "Every attempt from the fifth failure on should report the lock");
+            assert(users.Login("busy.user@test.com", "password123").find("Account locked") != std::string::npos &&
+                   "A locked account should refuse the right password");
+            assert(users.GetUserById(userId).AccessCount >= 5 && "Reads should see the live failure count");
+            assert(users.FlushLoginActivity() && "Flush failed");
+        }
+
+        Users reloaded(TEST_FILE);
+        auto locked = reloaded.GetUserById(userId);
+        assert(locked.AccessCount >= 5 && "The failure count should survive a restart");
+        assert(reloaded.Login("busy.user@test.com", "password123").find("Account locked") != std::string::npos &&
+               "The lock should survive a restart");
+
+        assert(reloaded.ResetFailedLogins(userId) && "Resetting the count failed");
+        assert(reloaded.Login("busy.user@test.com", "password123") == "success" &&
+               "Resetting the count should unlock the account");
+        std::cout << "Concurrent login test passed\n";
+    }
+
+    void TestStaleUpdateKeepsFailures() {
+        Users users(TEST_FILE);
+        UserDto user{};
+        user.FirstName = "Stale";
+        user.LastName = "Row";
+        user.Email = "stale.row@test.com";
+        user.PasswordHash = "password123";
+        user.Status = UserStatus::UserStatus_ACTIVE;
+        assert(users.AddUser(user) == "success" && "Add user failed");
+
+        // An admin edit read before these failures lands after them.
+        auto stale = users.GetUserByEmail(user.Email);
+        users.Login(user.Email, "wrongpass");
+        users.Login(user.Email, "wrongpass");
+        stale.Address = "Edited";
+        assert(users.UpdateUser(stale) && "Update user failed");
+        assert(users.UpdateUserStatus(stale.UserId, UserStatus::UserStatus_ACTIVE, "Admin") && "Status update failed");
+
+        auto current = users.GetUserById(stale.UserId);
+        assert(current.AccessCount == 2 && current.Address == "Edited" &&
+               "A stale row written back should keep the live failure count");
+        assert(users.FlushLoginActivity() && "Flush failed");
+        assert(Users(TEST_FILE).GetUserById(stale.UserId).AccessCount == 2 && "The count should be persisted");
+        assert(users.HardDeleteUser(stale.UserId) && "Hard delete failed");
+        std::cout << "Stale update test passed\n";
     }
 
 public:
@@ -176,9 +295,11 @@ public:
             TestGetUser();
             TestUpdateUser();
             TestUpdatePassword();
-            TestBookOperations();
             TestLogin();
             TestSoftDelete();
+            TestEmailIndex();
+            TestConcurrentLogins();
+            TestStaleUpdateKeepsFailures();
             // TearDown();
             std::cout << "All user tests passed!\n";
         }
@@ -2,56 +2,121 @@
 #define AUDIT_LOGGER_HPP
 
 #include <thread>
-#include <queue>
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <deque>
+#include <vector>
 #include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include "../Interfaces/Audits.hpp"
 
+// What LogAsync does when the queue is full.
+enum class BackpressurePolicy {
+    BLOCK,        // wait for the worker to make room
+    DROP_NEWEST,  // discard the incoming log
+    DROP_OLDEST   // discard the oldest queued log
+};
+
+struct AuditLoggerConfig {
+    size_t maxBatchSize = 256;
+    std::chrono::milliseconds maxLatency{50};
+    size_t queueCapacity = 10000;
+    BackpressurePolicy policy = BackpressurePolicy::BLOCK;
+};
+
+// Group-commits audit logs: the worker waits until a full batch is queued or
+// the oldest log has waited maxLatency, then persists the batch with one
+// Audits::AddAuditLogs call.
 class AuditLogger {
 private:
     Audits& audit;
+    AuditLoggerConfig config;
     bool running;
-    std::queue<AuditLogDto> logQueue;
+    std::deque<AuditLogDto> logQueue;
     std::mutex queueMutex;
     std::condition_variable condition;
+    std::condition_variable spaceAvailable;
+    std::atomic<size_t> droppedLogs{0};
     std::thread workerThread;
 
     void ProcessLogs() {
-        while (running) {
-            std::unique_lock<std::mutex> lock(queueMutex);
+        std::unique_lock<std::mutex> lock(queueMutex);
+        while (true) {
             condition.wait(lock, [this]{ return !logQueue.empty() || !running; });
+            if (logQueue.empty()) return;
+
+            auto deadline = std::chrono::steady_clock::now() + config.maxLatency;
+            condition.wait_until(lock, deadline, [this]{
+                return logQueue.size() >= config.maxBatchSize || !running;
+            });
+
+            size_t count = std::min(logQueue.size(), config.maxBatchSize);
+            std::vector<AuditLogDto> batch(std::make_move_iterator(logQueue.begin()),
+                                           std::make_move_iterator(logQueue.begin() + count));
+            logQueue.erase(logQueue.begin(), logQueue.begin() + count);
+            lock.unlock();
+            spaceAvailable.notify_all();
 
-            while (!logQueue.empty()) {
-                auto log = logQueue.front();
-                logQueue.pop();
-                lock.unlock();
-                audit.AddAuditLog(log);
-                lock.lock();
+            if (!audit.AddAuditLogs(std::move(batch))) {
+                std::cerr << "Failed to persist " << count << " audit log(s)" << std::endl;
             }
+            lock.lock();
         }
     }
 
 public:
-    AuditLogger(Audits& auditRef) : audit(auditRef), running(true) {
+    AuditLogger(Audits& auditRef, const AuditLoggerConfig& loggerConfig = AuditLoggerConfig())
+        : audit(auditRef), config(loggerConfig), running(true) {
+        if (config.maxBatchSize == 0) config.maxBatchSize = 1;
+        if (config.queueCapacity == 0) config.queueCapacity = 1;
         workerThread = std::thread(&AuditLogger::ProcessLogs, this);
     }
 
+    // Flushes everything still queued before returning.
     ~AuditLogger() {
         {
             std::lock_guard<std::mutex> lock(queueMutex);
             running = false;
         }
         condition.notify_one();
+        spaceAvailable.notify_all();
         if (workerThread.joinable()) {
             workerThread.join();
         }
     }
 
-    void LogAsync(AuditLogDto log) {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        logQueue.push(log);
-        condition.notify_one();
+    // Returns false when the log was dropped because the queue was full.
+    bool LogAsync(AuditLogDto log) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (logQueue.size() >= config.queueCapacity) {
+            switch (config.policy) {
+                case BackpressurePolicy::BLOCK:
+                    spaceAvailable.wait(lock, [this]{
+                        return logQueue.size() < config.queueCapacity || !running;
+                    });
+                    break;
+                case BackpressurePolicy::DROP_NEWEST:
+                    droppedLogs++;
+                    return false;
+                case BackpressurePolicy::DROP_OLDEST:
+                    logQueue.pop_front();
+                    droppedLogs++;
+                    break;
+            }
+        }
+        logQueue.push_back(std::move(log));
+        if (logQueue.size() == 1 || logQueue.size() >= config.maxBatchSize) {
+            condition.notify_one();
+        }
+        return true;
+    }
+
+    size_t DroppedLogs() const {
+        return droppedLogs;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,109 @@
+#ifndef AUTH_POOL_HPP
+#define AUTH_POOL_HPP
+
+#include <string>
+#include <optional>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+#include "ThreadPool.hpp"
+#include "HashUtils.hpp"
+
+struct AuthPoolStats {
+    size_t threads = 0;
+    size_t queueDepth = 0;
+    size_t queueCapacity = 0;
+    uint64_t completed = 0;
+    uint64_t rejected = 0;           // turned away because the queue was full
+    uint64_t averageWaitMicros = 0;  // queued until a hashing thread picked it up
+    uint64_t averageHashMicros = 0;
+    uint64_t maxHashMicros = 0;
+};
+
+// Password hashing runs on its own small pool so that a slow key derivation
+// only ever occupies these threads. The queue is bounded: when it is full a
+// request is refused at once rather than left to pile up behind the others.
+class AuthPool {
+public:
+    using HashFunction = std::function<std::string(const std::string&, const std::string&)>;
+
+private:
+    HashFunction hash;
+    size_t capacity;
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> totalWaitNanos{0};
+    std::atomic<uint64_t> totalHashNanos{0};
+    std::atomic<uint64_t> maxHashNanos{0};
+    ThreadPool pool;  // last, so it drains before the counters go away
+
+    static uint64_t Nanos(std::chrono::steady_clock::duration elapsed) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    void Record(uint64_t waitNanos, uint64_t hashNanos) {
+        totalWaitNanos += waitNanos;
+        totalHashNanos += hashNanos;
+        uint64_t longest = maxHashNanos.load();
+        while (hashNanos > longest && !maxHashNanos.compare_exchange_weak(longest, hashNanos)) {}
+        completed++;
+    }
+
+public:
+    AuthPool(size_t threadCount, size_t queueCapacity, HashFunction hashFunction = Utils::CreateSaltedHash)
+        : hash(std::move(hashFunction)), capacity(queueCapacity), pool(threadCount, queueCapacity) {}
+
+    AuthPool(const AuthPool&) = delete;
+    AuthPool& operator=(const AuthPool&) = delete;
+
+    // Hashes on a pool thread and waits for the result; nothing if the queue
+    // is full.
+    std::optional<std::string> Hash(const std::string& salt, const std::string& password) {
+        auto result = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> hashed = result->get_future();
+        auto queued = std::chrono::steady_clock::now();
+        bool accepted = pool.TrySubmit([this, result, queued, &salt, &password]() {
+            auto started = std::chrono::steady_clock::now();
+            try {
+                std::string value = hash(salt, password);
+                Record(Nanos(started - queued), Nanos(std::chrono::steady_clock::now() - started));
+                result->set_value(std::move(value));
+            } catch (...) {
+                result->set_exception(std::current_exception());
+            }
+        });
+        if (!accepted) {
+            rejected++;
+            return std::nullopt;
+        }
+        return hashed.get();
+    }
+
+    AuthPoolStats Stats() {
+        AuthPoolStats stats;
+        stats.threads = pool.ThreadCount();
+        stats.queueDepth = pool.QueueDepth();
+        stats.queueCapacity = capacity;
+        stats.completed = completed;
+        stats.rejected = rejected;
+        if (stats.completed > 0) {
+            stats.averageWaitMicros = totalWaitNanos / stats.completed / 1000;
+            stats.averageHashMicros = totalHashNanos / stats.completed / 1000;
+        }
+        stats.maxHashMicros = maxHashNanos / 1000;
+        return stats;
+    }
+
+    // The pool every user store hashes on: half the cores, so logins can
+    // never take all of them from request handling.
+    static AuthPool& Shared() {
+        static AuthPool shared(std::max(1u, std::thread::hardware_concurrency() / 2), 64);
+        return shared;
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef FRAMING_HPP
+#define FRAMING_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Wire format shared by LibraryServer and LibraryClient: every message is a
+// 4-byte big-endian payload length followed by the payload bytes.
+namespace Utils {
+    constexpr size_t FrameHeaderSize = 4;
+    constexpr uint32_t MaxFrameSize = 16 * 1024 * 1024;
+
+    inline void AppendFrame(std::string& out, const std::string& payload) {
+        uint32_t length = static_cast<uint32_t>(payload.size());
+        out.push_back(static_cast<char>((length >> 24) & 0xFF));
+        out.push_back(static_cast<char>((length >> 16) & 0xFF));
+        out.push_back(static_cast<char>((length >> 8) & 0xFF));
+        out.push_back(static_cast<char>(length & 0xFF));
+        out.append(payload);
+    }
+
+    inline std::string EncodeFrame(const std::string& payload) {
+        std::string frame;
+        frame.reserve(FrameHeaderSize + payload.size());
+        AppendFrame(frame, payload);
+        return frame;
+    }
+
+    // Reassembles frames from arbitrarily split stream reads. Bytes are
+    // buffered until a whole frame is available; a length above MaxFrameSize
+    // marks the stream as corrupt.
+    class FrameDecoder {
+    private:
+        std::string buffer;
+        size_t offset = 0;  // start of the first undecoded byte
+        bool failed = false;
+
+    public:
+        void Feed(const char* data, size_t size) {
+            if (offset > 0 && offset * 2 >= buffer.size()) {
+                buffer.erase(0, offset);
+                offset = 0;
+            }
+            buffer.append(data, size);
+        }
+
+        bool Next(std::string& frame) {
+            if (failed || buffer.size() - offset < FrameHeaderSize) return false;
+
+            const unsigned char* header = reinterpret_cast<const unsigned char*>(buffer.data() + offset);
+            uint32_t length = (uint32_t{header[0]} << 24) | (uint32_t{header[1]} << 16) |
+                              (uint32_t{header[2]} << 8) | uint32_t{header[3]};
+            if (length > MaxFrameSize) {
+                failed = true;
+                return false;
+            }
+            if (buffer.size() - offset - FrameHeaderSize < length) return false;
+
+            frame.assign(buffer, offset + FrameHeaderSize, length);
+            offset += FrameHeaderSize + length;
+            if (offset == buffer.size()) {
+                buffer.clear();
+                offset = 0;
+            }
+            return true;
+        }
+
+        bool Failed() const {
+            return failed;
+        }
+
+        size_t Buffered() const {
+            return buffer.size() - offset;
+        }
+    };
+}
+
+#endif
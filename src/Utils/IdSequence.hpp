@@ -0,0 +1,123 @@
+#ifndef ID_SEQUENCE_HPP
+#define ID_SEQUENCE_HPP
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+// Monotonic id allocator persisted in a small sidecar file (<data file>.seq)
+// holding the next free id. Each allocation locks the sidecar (a mutex for this
+// process, an flock for others), re-reads it, and writes and fdatasyncs the
+// advanced value before the id is handed out, so ids are never handed out
+// twice: not after deletes, not after a crash, and not between processes
+// sharing a store. The sidecar is locked rather than the store's .lock file,
+// because callers such as AddUser already hold that one.
+class IdSequence {
+private:
+    std::string path;
+    int fd;
+    int next;
+    std::mutex sequenceMutex;
+
+    class FileLock {
+    private:
+        int fd;
+
+    public:
+        explicit FileLock(int lockedFd) : fd(lockedFd) {
+            while (flock(fd, LOCK_EX) == -1 && errno == EINTR) {}
+        }
+        ~FileLock() { flock(fd, LOCK_UN); }
+        FileLock(const FileLock&) = delete;
+        FileLock& operator=(const FileLock&) = delete;
+    };
+
+    // Caller must hold sequenceMutex and a FileLock. 0 when nothing is stored.
+    int ReadLocked() const {
+        char buffer[16] = {0};
+        ssize_t bytesRead = pread(fd, buffer, sizeof(buffer) - 1, 0);
+        if (bytesRead <= 0) return 0;
+        int stored = std::atoi(buffer);
+        return stored > 0 ? stored : 0;
+    }
+
+    // Caller must hold sequenceMutex and a FileLock. Another process may have
+    // moved the sequence on, so start from whichever is further.
+    void CatchUpLocked() {
+        next = std::max(next, ReadLocked());
+    }
+
+    // Caller must hold sequenceMutex and a FileLock.
+    void PersistLocked() {
+        char buffer[16];
+        int length = std::snprintf(buffer, sizeof(buffer), "%011d\n", next);
+        if (pwrite(fd, buffer, static_cast<size_t>(length), 0) != length || fdatasync(fd) != 0) {
+            throw std::runtime_error("Failed to persist id sequence: " + path);
+        }
+    }
+
+public:
+    explicit IdSequence(const std::string& sidecarPath) : path(sidecarPath), next(1) {
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            throw std::runtime_error("Failed to open id sequence: " + path);
+        }
+    }
+
+    ~IdSequence() {
+        close(fd);
+    }
+
+    IdSequence(const IdSequence&) = delete;
+    IdSequence& operator=(const IdSequence&) = delete;
+
+    // Shares one sequence between every store instance opened on the same file.
+    static std::shared_ptr<IdSequence> For(const std::string& dataFile) {
+        static std::mutex registryMutex;
+        static std::unordered_map<std::string, std::weak_ptr<IdSequence>> registry;
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto& slot = registry[dataFile];
+        auto sequence = slot.lock();
+        if (!sequence) {
+            sequence = std::make_shared<IdSequence>(dataFile + ".seq");
+            slot = sequence;
+        }
+        return sequence;
+    }
+
+    // Raises the next id to at least floor, e.g. max existing id + 1.
+    void EnsureAtLeast(int floor) {
+        std::lock_guard<std::mutex> lock(sequenceMutex);
+        FileLock fileLock(fd);
+        CatchUpLocked();
+        next = std::max(next, floor);
+        PersistLocked();
+    }
+
+    int Next() {
+        std::lock_guard<std::mutex> lock(sequenceMutex);
+        FileLock fileLock(fd);
+        CatchUpLocked();
+        int id = next;
+        next = id + 1;
+        try {
+            PersistLocked();
+        } catch (...) {
+            next = id;
+            throw;
+        }
+        return id;
+    }
+};
+
+#endif
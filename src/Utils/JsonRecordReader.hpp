@@ -0,0 +1,211 @@
+#ifndef JSON_RECORD_READER_HPP
+#define JSON_RECORD_READER_HPP
+
+#include <nlohmann/json.hpp>
+#include <ctime>
+#include <istream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Streaming decoder for the store files: a JSON array of flat records (or a
+// single record, as on a JSON Lines row) is fed through nlohmann's SAX
+// interface straight into DTOs, without building a json DOM first.
+//
+// A Decoder names the record type and maps each scalar onto it:
+//
+//     struct CategoryDecoder {
+//         using Record = CategoryDto;
+//         static void Set(CategoryDto& record, const std::string& field,
+//                         const std::string& member, const Utils::JsonValue& value);
+//         static void BeginElement(CategoryDto& record, const std::string& field);
+//         static void Finish(CategoryDto& record);
+//     };
+//
+// `field` is the record-level key. Scalars inside an array field arrive with
+// an empty `member`; objects inside an array field are announced with
+// BeginElement and their keys arrive as `member`. Anything nested deeper is
+// skipped.
+namespace Utils {
+    struct JsonValue {
+        bool isText = false;
+        long long number = 0;
+        std::string* text = nullptr;
+
+        int Int() const { return static_cast<int>(number); }
+        std::time_t Time() const { return static_cast<std::time_t>(number); }
+        const std::string& Text() const {
+            static const std::string empty;
+            return isText ? *text : empty;
+        }
+        // Moves the string out of the parser's buffer; valid once per value.
+        std::string TakeString() const { return isText ? std::move(*text) : std::string(); }
+    };
+
+    // Skips records whose `field` holds a value `accept` rejects. Fields that
+    // follow the rejected one are not decoded and the record is never handed
+    // to the visitor. Records without the field are skipped as well.
+    struct JsonRecordFilter {
+        std::string field;
+        std::function<bool(const JsonValue&)> accept;
+    };
+
+    template <typename Decoder>
+    class JsonRecordHandler : public nlohmann::json_sax<nlohmann::json> {
+    public:
+        using Record = typename Decoder::Record;
+        using Visitor = std::function<bool(Record&)>;
+
+        JsonRecordHandler(const Visitor& recordVisitor, const JsonRecordFilter* recordFilter)
+            : visitor(recordVisitor), filter(recordFilter) {}
+
+        bool Stopped() const { return stopped; }
+        const std::string& Error() const { return error; }
+
+        bool null() override { return Scalar(JsonValue{}); }
+        bool boolean(bool value) override { return Scalar(JsonValue{false, value ? 1 : 0, nullptr}); }
+        bool number_integer(number_integer_t value) override { return Scalar(JsonValue{false, value, nullptr}); }
+        bool number_unsigned(number_unsigned_t value) override {
+            return Scalar(JsonValue{false, static_cast<long long>(value), nullptr});
+        }
+        bool number_float(number_float_t value, const string_t&) override {
+            return Scalar(JsonValue{false, static_cast<long long>(value), nullptr});
+        }
+        bool string(string_t& value) override { return Scalar(JsonValue{true, 0, &value}); }
+        bool binary(binary_t&) override { return Scalar(JsonValue{}); }
+
+        bool start_object(std::size_t) override {
+            if (containers.empty()) {
+                recordDepth = 1;  // a bare record rather than an array of them
+            }
+            containers.push_back('o');
+            if (containers.size() == recordDepth) {
+                record = Record{};
+                skipping = false;
+                matched = filter == nullptr;
+            } else if (containers.size() == recordDepth + 2 && containers[recordDepth] == 'a' && !skipping) {
+                Decoder::BeginElement(record, field);
+            }
+            return true;
+        }
+
+        bool end_object() override {
+            bool atRecord = containers.size() == recordDepth;
+            containers.pop_back();
+            if (atRecord && !skipping && matched) {
+                Decoder::Finish(record);
+                if (!visitor(record)) {
+                    stopped = true;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool start_array(std::size_t) override {
+            containers.push_back('a');
+            return true;
+        }
+
+        bool end_array() override {
+            containers.pop_back();
+            return true;
+        }
+
+        bool key(string_t& value) override {
+            if (containers.size() == recordDepth) {
+                field = value;
+                member.clear();
+            } else if (containers.size() == recordDepth + 1 || containers.size() == recordDepth + 2) {
+                member = value;
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+            error = ex.what();
+            return false;
+        }
+
+    private:
+        Visitor visitor;
+        const JsonRecordFilter* filter;
+        std::vector<char> containers;  // 'a' or 'o' for each open container
+        size_t recordDepth = 2;        // containers open while inside a record
+        Record record{};
+        std::string field;
+        std::string member;
+        bool skipping = false;
+        bool matched = true;
+        bool stopped = false;
+        std::string error;
+
+        bool Scalar(const JsonValue& value) {
+            if (skipping || containers.size() < recordDepth) return true;
+            if (containers.size() == recordDepth) {
+                if (filter != nullptr && field == filter->field) {
+                    if (!filter->accept(value)) {
+                        skipping = true;
+                        return true;
+                    }
+                    matched = true;
+                }
+                Decoder::Set(record, field, std::string(), value);
+            } else if (containers.size() == recordDepth + 1) {
+                Decoder::Set(record, field, containers.back() == 'a' ? std::string() : member, value);
+            } else if (containers.size() == recordDepth + 2 && containers[recordDepth] == 'a' &&
+                       containers.back() == 'o') {
+                Decoder::Set(record, field, member, value);
+            }
+            return true;
+        }
+    };
+
+    // Streams every record in `in` to visitor until it returns false. Throws
+    // std::runtime_error on malformed input, like parsing into a DOM would.
+    template <typename Decoder>
+    void ForEachJsonRecord(std::istream& in, const std::function<bool(typename Decoder::Record&)>& visitor,
+                           const JsonRecordFilter* filter = nullptr) {
+        JsonRecordHandler<Decoder> handler(visitor, filter);
+        if (!nlohmann::json::sax_parse(in, &handler) && !handler.Stopped()) {
+            throw std::runtime_error(handler.Error());
+        }
+    }
+
+    // Same, over a document already in memory (e.g. a store file read with pread).
+    template <typename Decoder>
+    void ForEachJsonRecord(const std::string& text, const std::function<bool(typename Decoder::Record&)>& visitor,
+                           const JsonRecordFilter* filter = nullptr) {
+        if (text.empty()) return;
+        JsonRecordHandler<Decoder> handler(visitor, filter);
+        if (!nlohmann::json::sax_parse(text, &handler) && !handler.Stopped()) {
+            throw std::runtime_error(handler.Error());
+        }
+    }
+
+    template <typename Decoder>
+    std::vector<typename Decoder::Record> ParseJsonRecords(const std::string& text,
+                                                           const JsonRecordFilter* filter = nullptr) {
+        std::vector<typename Decoder::Record> records;
+        ForEachJsonRecord<Decoder>(text, [&records](typename Decoder::Record& record) {
+            records.push_back(std::move(record));
+            return true;
+        }, filter);
+        return records;
+    }
+
+    // Decodes one JSON object (a JSON Lines row). Returns false if it is malformed.
+    template <typename Decoder>
+    bool ParseJsonRecord(const std::string& text, typename Decoder::Record& record) {
+        bool found = false;
+        JsonRecordHandler<Decoder> handler([&record, &found](typename Decoder::Record& decoded) {
+            record = std::move(decoded);
+            found = true;
+            return true;
+        }, nullptr);
+        return nlohmann::json::sax_parse(text, &handler) && found;
+    }
+}
+
+#endif
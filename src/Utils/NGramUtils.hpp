@@ -0,0 +1,47 @@
+#ifndef NGRAM_UTILS_HPP
+#define NGRAM_UTILS_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace Utils {
+    inline uint16_t PackBigram(char first, char second) {
+        return static_cast<uint16_t>((static_cast<uint8_t>(first) << 8) | static_cast<uint8_t>(second));
+    }
+
+    // Sorted, distinct packed bigrams of text; empty when text is shorter than a bigram.
+    inline std::vector<uint16_t> BigramSignature(const std::string& text) {
+        std::vector<uint16_t> codes;
+        if (text.size() < 2) return codes;
+        codes.reserve(text.size() - 1);
+        for (size_t i = 0; i + 1 < text.size(); i++) {
+            codes.push_back(PackBigram(text[i], text[i + 1]));
+        }
+        std::sort(codes.begin(), codes.end());
+        codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+        return codes;
+    }
+
+    // Dice coefficient of two bigram signatures: 2 * |common| / (|a| + |b|).
+    inline double BigramSimilarity(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+        if (a.empty() || b.empty()) return 0.0;
+        size_t common = 0;
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size()) {
+            if (a[i] < b[j]) {
+                i++;
+            } else if (b[j] < a[i]) {
+                j++;
+            } else {
+                common++;
+                i++;
+                j++;
+            }
+        }
+        return (2.0 * common) / (a.size() + b.size());
+    }
+}
+
+#endif
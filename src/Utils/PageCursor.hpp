@@ -0,0 +1,81 @@
+#ifndef PAGE_CURSOR_HPP
+#define PAGE_CURSOR_HPP
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdint>
+#include <cctype>
+
+// Paging for listing commands. A page ends with a cursor naming the last key
+// it returned; the next page resumes strictly after that key, so paging never
+// rescans or renders more than one page, whatever the size of the table.
+namespace Utils {
+    constexpr size_t DefaultPageSize = 20;
+    constexpr size_t MaxPageSize = 100;
+
+    // Opaque to clients: 'c' followed by the key fields in hex, '.'-separated.
+    inline std::string EncodeCursor(const std::vector<uint64_t>& key) {
+        static const char digits[] = "0123456789abcdef";
+        std::string cursor = "c";
+        for (size_t i = 0; i < key.size(); i++) {
+            if (i > 0) cursor += '.';
+            std::string field;
+            uint64_t value = key[i];
+            do {
+                field.insert(field.begin(), digits[value & 0xF]);
+                value >>= 4;
+            } while (value != 0);
+            cursor += field;
+        }
+        return cursor;
+    }
+
+    // False unless the cursor is well formed and has exactly `fields` fields.
+    inline bool DecodeCursor(const std::string& cursor, size_t fields, std::vector<uint64_t>& key) {
+        key.clear();
+        if (cursor.size() < 2 || cursor[0] != 'c') return false;
+        uint64_t value = 0;
+        size_t length = 0;
+        for (size_t i = 1; i <= cursor.size(); i++) {
+            char c = i < cursor.size() ? cursor[i] : '.';
+            if (c == '.') {
+                if (length == 0) return false;
+                key.push_back(value);
+                value = 0;
+                length = 0;
+                continue;
+            }
+            int digit = std::isdigit(static_cast<unsigned char>(c)) ? c - '0'
+                      : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+            if (digit < 0 || ++length > 16) return false;
+            value = (value << 4) | static_cast<uint64_t>(digit);
+        }
+        return key.size() == fields;
+    }
+
+    struct PageRequest {
+        std::string cursor;  // empty for the first page
+        size_t pageSize = DefaultPageSize;
+    };
+
+    // Arguments after the command number, in any order: a cursor from a
+    // previous page and/or a page size, clamped to [1, MaxPageSize].
+    inline PageRequest ParsePageRequest(const std::string& command) {
+        PageRequest page;
+        std::istringstream arguments(command);
+        std::string token;
+        arguments >> token;  // the command itself
+        while (arguments >> token) {
+            if (token[0] == 'c') {
+                page.cursor = token;
+            } else if (token.find_first_not_of("0123456789") == std::string::npos && token.size() < 6) {
+                size_t size = std::stoul(token);
+                page.pageSize = size == 0 ? 1 : (size > MaxPageSize ? MaxPageSize : size);
+            }
+        }
+        return page;
+    }
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef RESPONSE_BUFFER_HPP
+#define RESPONSE_BUFFER_HPP
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <ctime>
+#include <cstdint>
+#include <type_traits>
+
+#include "Framing.hpp"
+
+namespace Utils {
+    constexpr size_t UtcTimestampSize = 23;  // "YYYY-MM-DD HH:MM:SS UTC"
+
+    // Writes "YYYY-MM-DD HH:MM:SS UTC" without gmtime, so it is safe on any
+    // thread. The date half is cached per thread and only recomputed when the
+    // day changes, which for a listing of recent loans is rarely.
+    inline void FormatUtc(std::time_t time, char* out) {
+        thread_local int64_t cachedDay = INT64_MIN;
+        thread_local char cachedDate[10];
+
+        int64_t seconds = static_cast<int64_t>(time);
+        int64_t day = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+        int64_t secondOfDay = seconds - day * 86400;
+
+        if (day != cachedDay) {
+            // Civil date from days since 1970-01-01 (proleptic Gregorian).
+            int64_t z = day + 719468;
+            int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+            int64_t dayOfEra = z - era * 146097;
+            int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+            int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+            int64_t mp = (5 * dayOfYear + 2) / 153;
+            int64_t dayOfMonth = dayOfYear - (153 * mp + 2) / 5 + 1;
+            int64_t month = mp < 10 ? mp + 3 : mp - 9;
+            int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+            int64_t fields[3] = {year % 10000, month, dayOfMonth};
+            char* p = cachedDate;
+            for (int i = 0; i < 3; i++) {
+                int width = i == 0 ? 4 : 2;
+                for (int digit = width - 1; digit >= 0; digit--) {
+                    p[digit] = static_cast<char>('0' + fields[i] % 10);
+                    fields[i] /= 10;
+                }
+                p += width;
+                if (i < 2) *p++ = '-';
+            }
+            cachedDay = day;
+        }
+
+        for (int i = 0; i < 10; i++) out[i] = cachedDate[i];
+        int fields[3] = {static_cast<int>(secondOfDay / 3600), static_cast<int>(secondOfDay / 60 % 60),
+                         static_cast<int>(secondOfDay % 60)};
+        char* p = out + 10;
+        for (int i = 0; i < 3; i++) {
+            *p++ = i == 0 ? ' ' : ':';
+            *p++ = static_cast<char>('0' + fields[i] / 10);
+            *p++ = static_cast<char>('0' + fields[i] % 10);
+        }
+        *p++ = ' ';
+        *p++ = 'U';
+        *p++ = 'T';
+        *p = 'C';
+    }
+
+    // Tags a time to be written as a UTC timestamp rather than a number.
+    struct Utc {
+        std::time_t time;
+    };
+}
+
+// A reply under construction, already framed for the wire: the first bytes
+// are reserved for the frame header, so the finished buffer goes to the
+// socket as is. Each worker thread reuses one buffer, so steady-state
+// replies allocate nothing.
+class ResponseBuffer {
+private:
+    std::string bytes;
+    static constexpr size_t RetainedCapacity = 1024 * 1024;
+
+public:
+    ResponseBuffer() {
+        Clear();
+    }
+
+    // Empties the payload; the allocation is kept unless it grew unusually large.
+    void Clear() {
+        if (bytes.capacity() > RetainedCapacity) {
+            std::string().swap(bytes);
+        }
+        bytes.assign(Utils::FrameHeaderSize, '\0');
+    }
+
+    ResponseBuffer& operator<<(std::string_view text) {
+        bytes.append(text.data(), text.size());
+        return *this;
+    }
+
+    ResponseBuffer& operator<<(char c) {
+        bytes.push_back(c);
+        return *this;
+    }
+
+    template <typename Integer,
+              typename = std::enable_if_t<std::is_integral<Integer>::value && !std::is_same<Integer, char>::value &&
+                                          !std::is_same<Integer, bool>::value>>
+    ResponseBuffer& operator<<(Integer value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        bytes.append(digits, static_cast<size_t>(result.ptr - digits));
+        return *this;
+    }
+
+    ResponseBuffer& operator<<(Utils::Utc timestamp) {
+        size_t offset = bytes.size();
+        bytes.resize(offset + Utils::UtcTimestampSize);
+        Utils::FormatUtc(timestamp.time, &bytes[offset]);
+        return *this;
+    }
+
+    std::string_view Payload() const {
+        return std::string_view(bytes).substr(Utils::FrameHeaderSize);
+    }
+
+    // The reply with its frame header filled in, ready to send.
+    const std::string& Frame() {
+        uint32_t length = static_cast<uint32_t>(bytes.size() - Utils::FrameHeaderSize);
+        bytes[0] = static_cast<char>((length >> 24) & 0xFF);
+        bytes[1] = static_cast<char>((length >> 16) & 0xFF);
+        bytes[2] = static_cast<char>((length >> 8) & 0xFF);
+        bytes[3] = static_cast<char>(length & 0xFF);
+        return bytes;
+    }
+
+    // The calling worker's buffer.
+    static ResponseBuffer& ForThisThread() {
+        thread_local ResponseBuffer buffer;
+        return buffer;
+    }
+};
+
+#endif
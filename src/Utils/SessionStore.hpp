@@ -0,0 +1,115 @@
+#ifndef SESSION_STORE_HPP
+#define SESSION_STORE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Concurrent table of per-client state, sharded by client id. A shard lock is
+// only held to find or create an entry; the entry's own mutex then serializes
+// one client's requests without blocking any other client.
+template <typename T>
+class SessionStore {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::mutex mutex;
+        T value{};
+        Clock::time_point lastUsed{Clock::now()};
+        std::atomic<bool> detached{false};  // erased or evicted from its shard
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<int, std::shared_ptr<Entry>> entries;
+    };
+
+    static constexpr size_t ShardCount = 32;
+    std::array<Shard, ShardCount> shards;
+
+    Shard& ShardFor(int clientId) {
+        return shards[static_cast<unsigned int>(clientId) % ShardCount];
+    }
+
+    std::shared_ptr<Entry> FindOrCreate(int clientId) {
+        Shard& shard = ShardFor(clientId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& entry = shard.entries[clientId];
+        if (!entry) {
+            entry = std::make_shared<Entry>();
+        }
+        return entry;
+    }
+
+public:
+    // Exclusive access to one session for as long as the handle lives.
+    class Handle {
+    private:
+        std::shared_ptr<Entry> entry;
+        std::unique_lock<std::mutex> lock;
+
+    public:
+        Handle(std::shared_ptr<Entry> sessionEntry, std::unique_lock<std::mutex> sessionLock)
+            : entry(std::move(sessionEntry)), lock(std::move(sessionLock)) {}
+
+        T& operator*() { return entry->value; }
+        T* operator->() { return &entry->value; }
+    };
+
+    // Locks the client's session, creating it on first use.
+    Handle Acquire(int clientId) {
+        while (true) {
+            auto entry = FindOrCreate(clientId);
+            std::unique_lock<std::mutex> lock(entry->mutex);
+            if (entry->detached) continue;  // erased while we waited, start afresh
+            entry->lastUsed = Clock::now();
+            return Handle(std::move(entry), std::move(lock));
+        }
+    }
+
+    void Erase(int clientId) {
+        Shard& shard = ShardFor(clientId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(clientId);
+        if (it != shard.entries.end()) {
+            it->second->detached = true;
+            shard.entries.erase(it);
+        }
+    }
+
+    // Drops sessions untouched for longer than maxIdle. Sessions in use are
+    // skipped. Returns the number evicted.
+    size_t EvictIdle(std::chrono::seconds maxIdle) {
+        auto cutoff = Clock::now() - maxIdle;
+        size_t evicted = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                std::unique_lock<std::mutex> entryLock(it->second->mutex, std::try_to_lock);
+                if (entryLock.owns_lock() && it->second->lastUsed < cutoff) {
+                    it->second->detached = true;
+                    it = shard.entries.erase(it);
+                    evicted++;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return evicted;
+    }
+
+    size_t Size() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+};
+
+#endif
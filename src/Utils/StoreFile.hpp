@@ -0,0 +1,168 @@
+#ifndef STORE_FILE_HPP
+#define STORE_FILE_HPP
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+// Pooled descriptors for one JSON store file. Writers hold a Lock: a mutex for
+// threads of this process plus an flock on a sidecar (<data file>.lock), since
+// a lock on the data file itself would be lost when the file is renamed over.
+// Reads are pread()s on a cached descriptor. Writes go to <data file>.tmp, are
+// fsync'd and renamed over the data file, so a reader sees the old contents or
+// the new ones and never a partial file.
+class StoreFile {
+private:
+    std::string path;
+    std::string tempPath;
+    int lockFd;
+    int directoryFd;
+    int dataFd;
+    ino_t dataInode;
+    std::mutex writerMutex;
+    std::mutex descriptorMutex;
+
+    // Caller must hold descriptorMutex. Reopens the data file if another
+    // process has replaced it since it was opened here.
+    void RefreshLocked() {
+        struct stat current;
+        if (stat(path.c_str(), &current) == -1) {
+            CloseDataLocked();
+            return;
+        }
+        if (dataFd != -1 && current.st_ino == dataInode) return;
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            throw std::runtime_error("Failed to open store file: " + path);
+        }
+        CloseDataLocked();
+        dataFd = fd;
+        dataInode = current.st_ino;
+    }
+
+    void CloseDataLocked() {
+        if (dataFd != -1) close(dataFd);
+        dataFd = -1;
+    }
+
+public:
+    explicit StoreFile(const std::string& dataPath)
+        : path(dataPath), tempPath(dataPath + ".tmp"), dataFd(-1), dataInode(0) {
+        lockFd = open((path + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lockFd == -1) {
+            throw std::runtime_error("Failed to open store lock: " + path);
+        }
+        std::string directory = std::filesystem::path(path).parent_path().string();
+        directoryFd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    }
+
+    ~StoreFile() {
+        CloseDataLocked();
+        if (directoryFd != -1) close(directoryFd);
+        close(lockFd);
+    }
+
+    StoreFile(const StoreFile&) = delete;
+    StoreFile& operator=(const StoreFile&) = delete;
+
+    // Shares one set of descriptors between every store instance on the same file.
+    static std::shared_ptr<StoreFile> For(const std::string& dataPath) {
+        static std::mutex registryMutex;
+        static std::unordered_map<std::string, std::weak_ptr<StoreFile>> registry;
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        auto& slot = registry[dataPath];
+        auto file = slot.lock();
+        if (!file) {
+            file = std::make_shared<StoreFile>(dataPath);
+            slot = file;
+        }
+        return file;
+    }
+
+    // Exclusive writer lock, across threads and processes.
+    class Lock {
+    private:
+        StoreFile& file;
+        std::unique_lock<std::mutex> guard;
+
+    public:
+        explicit Lock(StoreFile& storeFile) : file(storeFile), guard(storeFile.writerMutex) {
+            while (flock(file.lockFd, LOCK_EX) == -1 && errno == EINTR) {}
+        }
+
+        ~Lock() {
+            flock(file.lockFd, LOCK_UN);
+        }
+
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+
+    // The whole file as last replaced; empty when it does not exist.
+    std::string Read() {
+        std::lock_guard<std::mutex> lock(descriptorMutex);
+        RefreshLocked();
+        if (dataFd == -1) return "";
+
+        struct stat info;
+        if (fstat(dataFd, &info) == -1) {
+            throw std::runtime_error("Failed to stat store file: " + path);
+        }
+        std::string contents(static_cast<size_t>(info.st_size), '\0');
+        size_t offset = 0;
+        while (offset < contents.size()) {
+            ssize_t bytesRead = pread(dataFd, &contents[offset], contents.size() - offset,
+                                      static_cast<off_t>(offset));
+            if (bytesRead < 0 && errno == EINTR) continue;
+            if (bytesRead < 0) {
+                throw std::runtime_error("Failed to read store file: " + path);
+            }
+            if (bytesRead == 0) break;
+            offset += static_cast<size_t>(bytesRead);
+        }
+        contents.resize(offset);
+        return contents;
+    }
+
+    // Caller must hold a Lock. The new contents are durable once this returns.
+    void Replace(const std::string& contents) {
+        int fd = open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            throw std::runtime_error("Failed to create " + tempPath);
+        }
+        size_t offset = 0;
+        while (offset < contents.size()) {
+            ssize_t written = pwrite(fd, contents.data() + offset, contents.size() - offset,
+                                     static_cast<off_t>(offset));
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) break;
+            offset += static_cast<size_t>(written);
+        }
+        struct stat info;
+        if (offset != contents.size() || fsync(fd) != 0 || fstat(fd, &info) != 0 ||
+            std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            close(fd);
+            unlink(tempPath.c_str());
+            throw std::runtime_error("Failed to write " + path);
+        }
+        if (directoryFd != -1) fsync(directoryFd);
+
+        // The temp descriptor now names the data file; keep it for reads.
+        std::lock_guard<std::mutex> lock(descriptorMutex);
+        CloseDataLocked();
+        dataFd = fd;
+        dataInode = info.st_ino;
+    }
+};
+
+#endif
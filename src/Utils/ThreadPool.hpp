@@ -0,0 +1,102 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <thread>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+
+// Fixed-size pool of worker threads draining a FIFO task queue. A capacity of
+// zero leaves the queue unbounded; otherwise Submit blocks and TrySubmit fails
+// while the queue is full.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    size_t capacity;
+    bool running;
+    std::mutex queueMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable spaceAvailable;
+
+    void Work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                taskAvailable.wait(lock, [this]{ return !tasks.empty() || !running; });
+                if (tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            spaceAvailable.notify_one();
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "Thread pool task failed: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Thread pool task failed" << std::endl;
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threadCount, size_t queueCapacity = 0)
+        : capacity(queueCapacity), running(true) {
+        if (threadCount == 0) threadCount = 1;
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(&ThreadPool::Work, this);
+        }
+    }
+
+    // Finishes every queued task before returning.
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            running = false;
+        }
+        taskAvailable.notify_all();
+        spaceAvailable.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    bool Submit(std::function<void()> task) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        spaceAvailable.wait(lock, [this]{ return capacity == 0 || tasks.size() < capacity || !running; });
+        if (!running) return false;
+        tasks.push(std::move(task));
+        lock.unlock();
+        taskAvailable.notify_one();
+        return true;
+    }
+
+    bool TrySubmit(std::function<void()> task) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (!running || (capacity != 0 && tasks.size() >= capacity)) return false;
+        tasks.push(std::move(task));
+        lock.unlock();
+        taskAvailable.notify_one();
+        return true;
+    }
+
+    size_t QueueDepth() {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return tasks.size();
+    }
+
+    size_t ThreadCount() const {
+        return workers.size();
+    }
+};
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <stdexcept>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Append-only, line-delimited record log. Appends are written immediately and
+// fsync'd in batches: after syncEvery records, or by the background flusher once
+// syncInterval has passed, whichever comes first. A failed sync is reported by
+// the append that triggered it; the background flusher has nobody to tell.
+class WriteAheadLog {
+private:
+    std::string path;
+    int fd;
+    size_t syncEvery;
+    std::chrono::milliseconds syncInterval;
+    size_t pendingSync;
+    size_t recordCount;
+    bool running;
+    std::mutex logMutex;
+    std::condition_variable condition;
+    std::thread flusherThread;
+
+    bool SyncLocked() {
+        if (pendingSync == 0) return true;
+        pendingSync = 0;
+        return fdatasync(fd) == 0;
+    }
+
+    void FlushPeriodically() {
+        std::unique_lock<std::mutex> lock(logMutex);
+        while (running) {
+            condition.wait_for(lock, syncInterval);
+            SyncLocked();
+        }
+    }
+
+public:
+    WriteAheadLog(const std::string& logPath, size_t syncEveryRecords = 64,
+                  std::chrono::milliseconds interval = std::chrono::milliseconds(200))
+        : path(logPath), syncEvery(syncEveryRecords == 0 ? 1 : syncEveryRecords),
+          syncInterval(interval), pendingSync(0), recordCount(0), running(true) {
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd == -1) {
+            throw std::runtime_error("Failed to open write-ahead log: " + path);
+        }
+        flusherThread = std::thread(&WriteAheadLog::FlushPeriodically, this);
+    }
+
+    ~WriteAheadLog() {
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            running = false;
+            SyncLocked();
+        }
+        condition.notify_one();
+        if (flusherThread.joinable()) {
+            flusherThread.join();
+        }
+        close(fd);
+    }
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // False if the record could not be written, or could not be synced when
+    // this append completes a batch. A partly written line is cut off again,
+    // so the next append does not land on a torn record and get discarded
+    // with it at replay; an unsynced one is cut off too, since the caller
+    // will treat it as never written.
+    bool Append(const std::string& record) {
+        std::string line = record + "\n";
+        std::lock_guard<std::mutex> lock(logMutex);
+        struct stat info;
+        if (fstat(fd, &info) == -1) return false;
+        const char* data = line.data();
+        size_t remaining = line.size();
+        while (remaining > 0) {
+            ssize_t written = write(fd, data, remaining);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (remaining < line.size()) {
+                    int ignored = ftruncate(fd, info.st_size);
+                    (void)ignored;
+                }
+                return false;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        if (++pendingSync >= syncEvery && !SyncLocked()) {
+            int ignored = ftruncate(fd, info.st_size);
+            (void)ignored;
+            return false;
+        }
+        recordCount++;
+        return true;
+    }
+
+    bool Sync() {
+        std::lock_guard<std::mutex> lock(logMutex);
+        return SyncLocked();
+    }
+
+    // Feeds every complete record to apply in log order. A last line with no
+    // newline is an append that never finished, and is cut off. A complete
+    // record that apply rejects is corruption rather than a torn write, so
+    // Replay throws instead of dropping the committed records behind it.
+    size_t Replay(const std::function<void(const std::string&)>& apply) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::string contents;
+        char buffer[65536];
+        off_t offset = 0;
+        ssize_t bytesRead;
+        while ((bytesRead = pread(fd, buffer, sizeof(buffer), offset)) > 0) {
+            contents.append(buffer, static_cast<size_t>(bytesRead));
+            offset += bytesRead;
+        }
+
+        size_t applied = 0;
+        size_t position = 0;
+        while (position < contents.size()) {
+            size_t newline = contents.find('\n', position);
+            if (newline == std::string::npos) break;
+            try {
+                apply(contents.substr(position, newline - position));
+            } catch (const std::exception& e) {
+                throw std::runtime_error("Corrupt record at offset " + std::to_string(position) +
+                                         " of " + path + ": " + e.what());
+            }
+            applied++;
+            position = newline + 1;
+        }
+
+        if (position < contents.size()) {
+            if (ftruncate(fd, static_cast<off_t>(position)) == 0) {
+                fdatasync(fd);
+            }
+        }
+        recordCount = applied;
+        return applied;
+    }
+
+    // Discards all records; call only once their effects are durable elsewhere.
+    bool Reset() {
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (ftruncate(fd, 0) != 0) return false;
+        fdatasync(fd);
+        pendingSync = 0;
+        recordCount = 0;
+        return true;
+    }
+
+    size_t RecordCount() {
+        std::lock_guard<std::mutex> lock(logMutex);
+        return recordCount;
+    }
+};
+
+#endif